@@ -36,6 +36,46 @@
         ["OS != \"linux\"", { "type": "none" }]
       ]
     },
+    {
+      "target_name": "linux-forkserver-shim",
+      "type": "shared_library",
+      "product_prefix": "",
+      "sources": [
+        "src/addons/linux-forkserver-shim.c"
+      ],
+      "cflags": [ "-fPIC" ],
+      "libraries": [ "-ldl" ],
+      "conditions": [
+        ["OS != \"linux\"", { "type": "none" }]
+      ]
+    },
+    {
+      "target_name": "linux-memory-shim",
+      "type": "shared_library",
+      "product_prefix": "",
+      "sources": [
+        "src/addons/linux-memory-shim.c"
+      ],
+      "cflags": [ "-fPIC" ],
+      "conditions": [
+        ["OS != \"linux\"", { "type": "none" }]
+      ]
+    },
+    {
+      "target_name": "hash",
+      "sources": [
+        "src/addons/hash.cpp"
+      ],
+      "include_dirs": [
+        "<!(node -p \"require('node-addon-api').include_dir\")"
+      ],
+      "dependencies": [
+        "<!(node -p \"require('node-addon-api').gyp\")"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ]
+    },
     {
       "target_name": "darwin-process-monitor",
       "sources": [
@@ -20,7 +20,16 @@ function getSharedConfig(isProd: boolean, mode: Configuration["mode"]): Configur
 }
 
 function addonCopyPlugins(): Configuration["plugins"] {
-  const plugins: Configuration["plugins"] = [];
+  const plugins: Configuration["plugins"] = [
+    new CopyRspackPlugin({
+      patterns: [
+        {
+          from: path.join("build", "Release", "hash.node"),
+          to: "hash.node",
+        },
+      ],
+    }),
+  ];
 
   if (process.platform === "win32") {
     const winMonitorPath = path.join("build", "Release", "win32-process-monitor.node");
@@ -36,6 +45,9 @@ function addonCopyPlugins(): Configuration["plugins"] {
     );
   } else if (process.platform === "linux") {
     const linuxMonitorPath = path.join("build", "Release", "linux-process-monitor.node");
+    // node-gyp puts shared libraries in their own directory
+    const linuxShimPath = path.join("build", "Release", "lib.target", "linux-forkserver-shim.so");
+    const linuxMemoryShimPath = path.join("build", "Release", "lib.target", "linux-memory-shim.so");
     plugins.push(
       new CopyRspackPlugin({
         patterns: [
@@ -43,6 +55,14 @@ function addonCopyPlugins(): Configuration["plugins"] {
             from: linuxMonitorPath,
             to: "linux-process-monitor.node",
           },
+          {
+            from: linuxShimPath,
+            to: "linux-forkserver-shim.so",
+          },
+          {
+            from: linuxMemoryShimPath,
+            to: "linux-memory-shim.so",
+          },
         ],
       })
     );
@@ -122,6 +142,9 @@ const webviewsConfig = (isProd: boolean, mode: Configuration["mode"]): Configura
   output: {
     path: path.resolve("./dist"),
     filename: "[name].js",
+    // Lazily imported components; the public path is set at runtime from the webview URI
+    chunkFilename: "chunks/[name].[contenthash:8].js",
+    cssChunkFilename: "chunks/[name].[contenthash:8].css",
   },
   target: ["web", "es2015"],
   resolve: {
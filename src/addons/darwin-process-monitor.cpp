@@ -7,6 +7,7 @@
 #include <cstring>
 #include <fcntl.h>
 #include <libproc.h>
+#include <map>
 #include <mach/mach.h>
 #include <mach/mach_time.h>
 #include <signal.h>
@@ -19,9 +20,13 @@
 #include <sys/time.h>
 #include <sys/un.h>
 #include <sys/wait.h>
+#include <system_error>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
+extern char **environ;
+
 // macOS implementation using kqueue for efficient process monitoring
 // Combined with resource limits enforced by polling and wait4 for stats
 //
@@ -105,6 +110,52 @@ static ProcessStats GetProcessStats(pid_t pid) {
   return stats;
 }
 
+// Samples the CPU time of every thread through proc_pidinfo, which works for
+// processes of the same user without a task port. Threads that start and exit
+// between two samples are not seen.
+class ThreadSampler {
+public:
+  explicit ThreadSampler(pid_t pid) : pid_(pid) {}
+
+  void Sample() {
+    uint64_t ids[256];
+    int bytes = proc_pidinfo(pid_, PROC_PIDLISTTHREADS, 0, ids, sizeof(ids));
+    if (bytes <= 0)
+      return;
+
+    uint32_t live = 0;
+    int count = bytes / static_cast<int>(sizeof(uint64_t));
+    for (int i = 0; i < count; i++) {
+      struct proc_threadinfo info;
+      if (proc_pidinfo(pid_, PROC_PIDTHREADINFO, ids[i], &info,
+                       sizeof(info)) == sizeof(info)) {
+        // Nanoseconds, unlike proc_pid_rusage which reports Mach ticks
+        threadCpuMs_[ids[i]] =
+            (info.pth_user_time + info.pth_system_time) / 1000000ULL;
+        live++;
+      }
+    }
+    peakThreads_ = std::max(peakThreads_, live);
+  }
+
+  uint32_t PeakThreads() const { return peakThreads_; }
+
+  // Last sampled CPU time of each thread seen, busiest first
+  std::vector<uint64_t> ThreadCpuMs() const {
+    std::vector<uint64_t> result;
+    for (const auto &entry : threadCpuMs_) {
+      result.push_back(entry.second);
+    }
+    std::sort(result.rbegin(), result.rend());
+    return result;
+  }
+
+private:
+  pid_t pid_;
+  std::map<uint64_t, uint64_t> threadCpuMs_;
+  uint32_t peakThreads_ = 0;
+};
+
 // AsyncWorker for waiting on process completion
 // Shared state for synchronization between worker and JS thread
 struct SharedStopState {
@@ -144,22 +195,50 @@ struct SharedStopState {
 class WaitForProcessWorker : public Napi::AsyncWorker {
 public:
   WaitForProcessWorker(Napi::Env &env, pid_t pid, uint32_t timeoutMs,
-                       uint64_t memoryLimitBytes,
+                       uint64_t memoryLimitBytes, bool wallTimeLimit,
+                       std::chrono::steady_clock::time_point startTime,
                        std::shared_ptr<SharedStopState> sharedState)
       : Napi::AsyncWorker(env), pid_(pid), timeoutMs_(timeoutMs),
-        memoryLimitBytes_(memoryLimitBytes), deferred_(env), elapsedMs_(0.0),
-        peakMemoryBytes_(0), exitCode_(0), termSignal_(0), timedOut_(false),
-        memoryLimitExceeded_(false), stopped_(false), errorMsg_(""),
-        sharedState_(sharedState) {}
+        memoryLimitBytes_(memoryLimitBytes), wallTimeLimit_(wallTimeLimit),
+        startTime_(startTime), deferred_(env), elapsedMs_(0.0), cpuMs_(0.0),
+        wallMs_(0.0), peakMemoryBytes_(0), exitCode_(0), termSignal_(0),
+        timedOut_(false), memoryLimitExceeded_(false), stopped_(false),
+        errorMsg_(""), sharedState_(sharedState), threads_(pid) {}
 
   ~WaitForProcessWorker() {
-    // no-op, shared state destructor handles fd
+    // Only if the worker never ran, e.g. on teardown. Don't leave the thread
+    // watching a process nobody waits for.
+    if (monitor_.joinable()) {
+      sharedState_->SignalStop();
+      monitor_.join();
+    }
   }
 
   Napi::Promise GetPromise() { return deferred_.Promise(); }
 
+  // Starts watching the process on its own thread, right after spawn. The
+  // worker itself may wait for a free threadpool thread behind other runs, and
+  // that wait must not leave the process unwatched or count as its wall time.
+  void Start() {
+    try {
+      monitor_ = std::thread([this] { Monitor(); });
+    } catch (const std::system_error &) {
+      // Watched from Execute instead
+    }
+  }
+
 protected:
   void Execute() override {
+    if (monitor_.joinable()) {
+      monitor_.join();
+    } else {
+      Monitor();
+    }
+  }
+
+  // Waits for the process while enforcing its limits, then collects its
+  // status and usage
+  void Monitor() {
     // Note: Resource limits (CPU and Memory) are enforced via polling in the
     // monitoring loop. RLIMIT_CPU/RLIMIT_AS are not set here.
 
@@ -197,7 +276,10 @@ protected:
 
     // Wait for either process exit, stop signal, or timeout
     if (shouldWait) {
-      auto startTime = std::chrono::steady_clock::now();
+      // Wall time mode stops at the limit, CPU time mode has a 2x safety net
+      long wallLimitMs =
+          wallTimeLimit_ ? (long)timeoutMs_ : (long)timeoutMs_ * 2;
+      uint32_t iteration = 0;
 
       while (true) {
         struct kevent event;
@@ -212,9 +294,9 @@ protected:
         if (timeoutMs_ > 0) {
           auto now = std::chrono::steady_clock::now();
           auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                             now - startTime)
+                             now - startTime_)
                              .count();
-          long remaining = (long)timeoutMs_ - elapsed;
+          long remaining = wallLimitMs - elapsed;
           if (remaining <= 0) {
             waitMs = 0; // Check one last time
           } else {
@@ -253,6 +335,11 @@ protected:
 
         // Timeout or Interval Wakeup
         if (nev == 0) {
+          // Threads are sampled every 50ms, which is plenty for reporting
+          if (iteration++ % 5 == 0) {
+            threads_.Sample();
+          }
+
           // Check Process Stats (CPU and Memory)
           if (memoryLimitBytes_ > 0 || timeoutMs_ > 0) {
             ProcessStats stats = GetProcessStats(pid_);
@@ -267,7 +354,7 @@ protected:
               }
 
               // Check CPU Time
-              if (timeoutMs_ > 0) {
+              if (timeoutMs_ > 0 && !wallTimeLimit_) {
                 uint64_t cpuLimitNs = (uint64_t)timeoutMs_ * 1000000ULL;
                 if (stats.total_cpu_time_ns > cpuLimitNs) {
                   timedOut_ = true;
@@ -278,16 +365,15 @@ protected:
             }
           }
 
-          // Check Wall Clock Timeout (Safety net)
+          // Check Wall Clock Timeout: the limit itself in wall time mode,
+          // otherwise a 2x safety net to allow for I/O waits etc.
           if (timeoutMs_ > 0) {
             auto now = std::chrono::steady_clock::now();
             auto elapsed =
-                std::chrono::duration_cast<std::chrono::milliseconds>(now -
-                                                                      startTime)
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - startTime_)
                     .count();
-            // Use a multiplier (e.g. 2x) for wall clock safety net to allow for
-            // I/O waits etc.
-            if (elapsed > (long)timeoutMs_ * 2) {
+            if (elapsed > wallLimitMs) {
               timedOut_ = true;
               kill(pid_, SIGKILL);
               break;
@@ -297,6 +383,11 @@ protected:
       }
     }
 
+    wallMs_ = std::round(
+        std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startTime_)
+            .count());
+
     // Mark shared state as closed so cancel() becomes no-op
     sharedState_->Close();
 
@@ -315,10 +406,11 @@ protected:
     uint64_t cpuUs =
         (rusage.ru_utime.tv_sec + rusage.ru_stime.tv_sec) * 1000000ULL +
         (rusage.ru_utime.tv_usec + rusage.ru_stime.tv_usec);
-    elapsedMs_ = std::round(static_cast<double>(cpuUs) / 1000.0);
+    cpuMs_ = std::round(static_cast<double>(cpuUs) / 1000.0);
+    elapsedMs_ = wallTimeLimit_ ? wallMs_ : cpuMs_;
 
-    // Post-mortem CPU Time Check: Catch CPU time that exceeded limit between
-    // poll intervals or if process ended naturally just before detection
+    // Post-mortem Time Check: Catch time that exceeded limit between poll
+    // intervals or if process ended naturally just before detection
     if (timeoutMs_ > 0 && elapsedMs_ > timeoutMs_) {
       timedOut_ = true;
     }
@@ -376,6 +468,17 @@ protected:
 
     Napi::Object result = Napi::Object::New(env);
     result.Set("elapsedMs", Napi::Number::New(env, elapsedMs_));
+    result.Set("cpuMs", Napi::Number::New(env, cpuMs_));
+    result.Set("wallMs", Napi::Number::New(env, wallMs_));
+    result.Set("threadCount", Napi::Number::New(env, threads_.PeakThreads()));
+    std::vector<uint64_t> threadCpuMs = threads_.ThreadCpuMs();
+    Napi::Array threadCpuArray = Napi::Array::New(env, threadCpuMs.size());
+    for (size_t i = 0; i < threadCpuMs.size(); i++) {
+      threadCpuArray.Set(
+          static_cast<uint32_t>(i),
+          Napi::Number::New(env, static_cast<double>(threadCpuMs[i])));
+    }
+    result.Set("threadCpuMs", threadCpuArray);
     result.Set("peakMemoryBytes",
                Napi::Number::New(env, static_cast<double>(peakMemoryBytes_)));
 
@@ -399,8 +502,12 @@ private:
   pid_t pid_;
   uint32_t timeoutMs_;
   uint64_t memoryLimitBytes_;
+  bool wallTimeLimit_;
+  std::chrono::steady_clock::time_point startTime_;
   Napi::Promise::Deferred deferred_;
-  double elapsedMs_;
+  double elapsedMs_; // time charged against the limit
+  double cpuMs_;
+  double wallMs_;
   uint64_t peakMemoryBytes_;
   int exitCode_;
   int termSignal_;
@@ -409,6 +516,8 @@ private:
   bool stopped_;
   std::string errorMsg_;
   std::shared_ptr<SharedStopState> sharedState_;
+  ThreadSampler threads_;
+  std::thread monitor_;
 };
 
 // Helper to convert Napi::Value to std::string
@@ -439,6 +548,13 @@ std::vector<std::string> ToArgv(Napi::Array args) {
 // 6: pipeNameOut (string)
 // 7: pipeNameErr (string)
 // 8: onSpawn (function)
+// 9: options (object, optional)
+//    - cpuAffinity (number): ignored, macOS has no API to pin a process to a
+//      CPU
+//    - timeLimitMode ("cpu" | "wall"): which time timeoutMs limits, default
+//      "cpu"
+//    - env (array of "KEY=VALUE" strings): the child's whole environment,
+//      inherited from this process when absent
 // Returns: { pid: number, result: Promise<AddonResult> }
 //
 Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
@@ -464,10 +580,30 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
 
   Napi::Function onSpawn = info[8].As<Napi::Function>();
 
+  bool wallTimeLimit = false;
+  bool customEnv = false;
+  std::vector<std::string> envStrings;
+  if (info.Length() > 9 && info[9].IsObject()) {
+    Napi::Object options = info[9].As<Napi::Object>();
+    wallTimeLimit = ToString(options.Get("timeLimitMode")) == "wall";
+    Napi::Value envValue = options.Get("env");
+    if (envValue.IsArray()) {
+      customEnv = true;
+      envStrings = ToArgv(envValue.As<Napi::Array>());
+    }
+  }
+
   // Pre-convert JS values to C++ strings/vectors in the parent process.
   // DO NOT access 'info', 'argsArray' in the child process after fork().
   std::vector<std::string> args = ToArgv(argsArray);
 
+  // macOS has no execvpe, so the child swaps environ before execvp instead
+  std::vector<char *> envp;
+  for (auto &entry : envStrings) {
+    envp.push_back(const_cast<char *>(entry.c_str()));
+  }
+  envp.push_back(nullptr);
+
   // Create a pipe to communicate errors from child to parent
   int err_pipe[2];
   if (pipe(err_pipe) == -1) {
@@ -485,6 +621,7 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
     return env.Null();
   }
 
+  auto startTime = std::chrono::steady_clock::now();
   pid_t pid = fork();
 
   if (pid < 0) {
@@ -561,7 +698,10 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
     argv.push_back(nullptr);
 
     // Execute
-    // Use execvp to inherit environment
+    // Use execvp to inherit environment, or the custom one with PATH from it
+    if (customEnv) {
+      environ = envp.data();
+    }
     execvp(command.c_str(), argv.data());
 
     // If exec fails
@@ -593,8 +733,9 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
 
   // Start monitoring immediataely
   auto worker = new WaitForProcessWorker(env, pid, timeoutMs, memoryLimitBytes,
-                                         sharedState);
+                                         wallTimeLimit, startTime, sharedState);
   auto promise = worker->GetPromise();
+  worker->Start();
   worker->Queue();
 
   Napi::Object result = Napi::Object::New(env);
@@ -0,0 +1,153 @@
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "linux-forkserver.h"
+
+// LD_PRELOAD shim that turns a dynamically linked program into a fork server.
+//
+// It interposes __libc_start_main and swaps main for a loop that forks a fresh
+// child on every request from the process monitor. By then the program has
+// been exec'd, dynamically linked, relocated, and statically initialized, so a
+// child only pays for fork and copy-on-write faults. Each child continues into
+// the real main with the stdio the monitor sent. See linux-forkserver.h for
+// the protocol.
+//
+// Without FOC_FORKSERVER_FD in the environment the program runs normally.
+
+typedef int (*MainFn)(int, char **, char **);
+typedef int (*LibcStartMainFn)(MainFn, int, char **, void (*)(void),
+                               void (*)(void), void (*)(void), void *);
+
+static MainFn realMain;
+static int controlFd = -1;
+
+static int SendPacket(const void *data, size_t size) {
+  ssize_t n;
+  do {
+    n = send(controlFd, data, size, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  return n == (ssize_t)size ? 0 : -1;
+}
+
+static int ReceiveRequest(struct ForkServerRequest *request, int fds[3]) {
+  char control[CMSG_SPACE(3 * sizeof(int))];
+  struct iovec iov = {request, sizeof(*request)};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t n;
+  do {
+    n = recvmsg(controlFd, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  if (n != sizeof(*request))
+    return -1;
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(3 * sizeof(int)))
+    return -1;
+  memcpy(fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+  return 0;
+}
+
+static int ForkServerMain(int argc, char **argv, char **envp) {
+  // Anything static initializers buffered went to /dev/null, don't let every
+  // child flush a copy into its stdout
+  fflush(NULL);
+
+  struct ForkServerSpawned hello = {(int32_t)getpid(), 0};
+  if (SendPacket(&hello, sizeof(hello)) < 0)
+    _exit(1);
+
+  for (;;) {
+    struct ForkServerRequest request;
+    int fds[3];
+    if (ReceiveRequest(&request, fds) < 0)
+      _exit(0); // the monitor closed the server
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(controlFd);
+      // Don't outlive the server if the monitor kills it mid-run
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (dup2(fds[0], STDIN_FILENO) < 0 || dup2(fds[1], STDOUT_FILENO) < 0 ||
+          dup2(fds[2], STDERR_FILENO) < 0)
+        _exit(1);
+      for (int i = 0; i < 3; i++) {
+        if (fds[i] > STDERR_FILENO)
+          close(fds[i]);
+      }
+
+      // Best effort, like a normal spawn
+      if (request.cpuAffinity >= 0 && request.cpuAffinity < CPU_SETSIZE) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(request.cpuAffinity, &cpuSet);
+        sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+      }
+      return realMain(argc, argv, envp);
+    }
+
+    int forkErrno = errno;
+    for (int i = 0; i < 3; i++)
+      close(fds[i]);
+
+    struct ForkServerSpawned spawned = {(int32_t)pid, pid < 0 ? forkErrno : 0};
+    if (SendPacket(&spawned, sizeof(spawned)) < 0)
+      _exit(1);
+    if (pid < 0)
+      continue;
+
+    struct ForkServerExit report;
+    memset(&report, 0, sizeof(report));
+    int status = 0;
+    while (wait4(pid, &status, 0, &report.usage) < 0 && errno == EINTR) {
+    }
+    report.status = status;
+    if (SendPacket(&report, sizeof(report)) < 0)
+      _exit(1);
+  }
+}
+
+int __libc_start_main(MainFn main, int argc, char **argv, void (*init)(void),
+                      void (*fini)(void), void (*rtldFini)(void),
+                      void *stackEnd) {
+  LibcStartMainFn next =
+      (LibcStartMainFn)dlsym(RTLD_NEXT, "__libc_start_main");
+
+  const char *fd = getenv(FOC_FORKSERVER_FD_ENV);
+  if (fd) {
+    controlFd = atoi(fd);
+    fcntl(controlFd, F_SETFD, FD_CLOEXEC);
+    realMain = main;
+    main = ForkServerMain;
+
+    // Programs the solution runs shouldn't become fork servers too. Drop
+    // only the shim, the user's own preloads follow it.
+    unsetenv(FOC_FORKSERVER_FD_ENV);
+    const char *preload = getenv("LD_PRELOAD");
+    const char *rest = preload ? strchr(preload, ':') : NULL;
+    if (rest && rest[1] != '\0')
+      setenv("LD_PRELOAD", rest + 1, 1);
+    else
+      unsetenv("LD_PRELOAD");
+  }
+  return next(main, argc, argv, init, fini, rtldFini, stackEnd);
+}
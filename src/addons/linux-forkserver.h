@@ -0,0 +1,35 @@
+#ifndef FOC_LINUX_FORKSERVER_H
+#define FOC_LINUX_FORKSERVER_H
+
+#include <stdint.h>
+#include <sys/resource.h>
+
+// Protocol between the process monitor and linux-forkserver-shim.so, over a
+// SOCK_SEQPACKET socketpair whose child end is passed to the solution by fd
+// number. Every message is one packet.
+//
+//   server -> monitor  ForkServerSpawned { server pid } once, right before main
+//   monitor -> server  ForkServerRequest, with stdin/stdout/stderr as
+//                      SCM_RIGHTS
+//   server -> monitor  ForkServerSpawned { child pid } right after fork
+//   server -> monitor  ForkServerExit once the child is reaped
+//
+// Only one child runs at a time. Closing the monitor's end stops the server.
+
+#define FOC_FORKSERVER_FD_ENV "FOC_FORKSERVER_FD"
+
+struct ForkServerRequest {
+  int32_t cpuAffinity; // pin the child to this CPU index, -1 to disable
+};
+
+struct ForkServerSpawned {
+  int32_t pid;
+  int32_t error; // errno of a failed fork, pid is -1 then
+};
+
+struct ForkServerExit {
+  int32_t status; // as returned by wait4
+  struct rusage usage;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// LD_PRELOAD shim that applies a memory policy to a solution before main.
+//
+//   FOC_HUGE_PAGES=always  madvise(MADV_HUGEPAGE) the writable private
+//                          mappings, so static arrays and the initial heap get
+//                          transparent huge pages when the system policy is
+//                          "madvise". Later malloc memory is covered by the
+//                          glibc.malloc.hugetlb tunable set next to it.
+//   FOC_PREFAULT=1         fault in the writable private mappings, so static
+//                          arrays are charged in full like on judges that
+//                          count committed memory instead of touched pages
+//
+// Neither is inherited by programs the solution runs.
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23 // Linux 5.14
+#endif
+
+#define MAX_RANGES 256
+
+struct Range {
+  uintptr_t start;
+  uintptr_t end;
+};
+
+// Writable private mappings except the stack and kernel provided ones, read
+// up front since madvise may split or merge them while we go
+static size_t ReadWritableRanges(struct Range *ranges) {
+  FILE *maps = fopen("/proc/self/maps", "r");
+  if (!maps)
+    return 0;
+
+  size_t count = 0;
+  char line[512];
+  while (count < MAX_RANGES && fgets(line, sizeof(line), maps)) {
+    unsigned long start, end;
+    char perms[5];
+    int nameOffset = 0;
+    if (sscanf(line, "%lx-%lx %4s %*s %*s %*s %n", &start, &end, perms,
+               &nameOffset) < 3)
+      continue;
+    if (perms[0] != 'r' || perms[1] != 'w' || perms[3] != 'p')
+      continue;
+    const char *name = line + nameOffset;
+    if (name[0] == '[' && strncmp(name, "[heap]", 6) != 0)
+      continue; // [stack], [vvar], [vsyscall], ...
+    ranges[count].start = start;
+    ranges[count].end = end;
+    count++;
+  }
+  fclose(maps);
+  return count;
+}
+
+static void Prefault(struct Range range) {
+  if (madvise((void *)range.start, range.end - range.start,
+              MADV_POPULATE_WRITE) == 0)
+    return;
+
+  // Older kernels: touch one byte per page without changing it
+  long pageSize = sysconf(_SC_PAGESIZE);
+  for (uintptr_t page = range.start; page < range.end; page += pageSize) {
+    volatile char *byte = (volatile char *)page;
+    *byte = *byte;
+  }
+}
+
+__attribute__((constructor)) static void ApplyMemoryPolicy(void) {
+  const char *hugePages = getenv("FOC_HUGE_PAGES");
+  const char *prefault = getenv("FOC_PREFAULT");
+  int adviseHugePages = hugePages && strcmp(hugePages, "always") == 0;
+  int shouldPrefault = prefault && strcmp(prefault, "1") == 0;
+
+  unsetenv("FOC_HUGE_PAGES");
+  unsetenv("FOC_PREFAULT");
+  // Drop only the shim, the user's own preloads follow it
+  const char *preload = getenv("LD_PRELOAD");
+  const char *rest = preload ? strchr(preload, ':') : NULL;
+  if (rest && rest[1] != '\0')
+    setenv("LD_PRELOAD", rest + 1, 1);
+  else
+    unsetenv("LD_PRELOAD");
+  if (!adviseHugePages && !shouldPrefault)
+    return;
+
+  struct Range ranges[MAX_RANGES];
+  size_t count = ReadWritableRanges(ranges);
+  for (size_t i = 0; i < count; i++) {
+    // Advise first so the prefault already faults in huge pages
+    if (adviseHugePages)
+      madvise((void *)ranges[i].start, ranges[i].end - ranges[i].start,
+              MADV_HUGEPAGE);
+    if (shouldPrefault)
+      Prefault(ranges[i]);
+  }
+}
@@ -1,57 +1,190 @@
 #include <napi.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <dirent.h>
 #include <fcntl.h>
+#include <map>
 #include <poll.h>
+#include <sched.h>
 #include <string>
 #include <sys/eventfd.h>
+#include <sys/prctl.h>
 #include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/un.h>
 #include <sys/wait.h>
+#include <system_error>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
+#include "linux-forkserver.h"
+
 // Linux process monitoring implementation using pidfd_open, poll, and wait4.
 //
 // Exports:
 //   spawn(...) -> { pid: number, result: Promise<AddonResult> }
+//   startForkServer(...) -> Promise<{ pid, spawn(...), close() }>
+//   createCancelGroup() -> { cancel(): number, handle }
 //
 
+extern char **environ;
+
 static int pidfd_open(pid_t pid, unsigned int flags) {
   return syscall(SYS_pidfd_open, pid, flags);
 }
 
+static int pidfd_send_signal(int pidfd, int sig, siginfo_t *info,
+                             unsigned int flags) {
+  return syscall(SYS_pidfd_send_signal, pidfd, sig, info, flags);
+}
+
 namespace {
 
+// Samples the CPU time of every thread from /proc/<pid>/task/<tid>/stat. The
+// task directory and each thread's stat file stay open between samples and
+// are re-read from offset 0, so a sample costs one getdents plus one pread per
+// thread. Threads that start and exit between two samples are not seen.
+class ThreadSampler {
+public:
+  explicit ThreadSampler(pid_t pid) {
+    std::string path = "/proc/" + std::to_string(pid) + "/task";
+    taskDir_ = opendir(path.c_str());
+  }
+
+  ~ThreadSampler() {
+    for (auto &entry : threads_) {
+      if (entry.second.fd >= 0)
+        close(entry.second.fd);
+    }
+    if (taskDir_)
+      closedir(taskDir_);
+  }
+
+  void Sample() {
+    if (!taskDir_)
+      return;
+
+    rewinddir(taskDir_);
+    uint32_t live = 0;
+    while (struct dirent *entry = readdir(taskDir_)) {
+      if (entry->d_name[0] < '0' || entry->d_name[0] > '9')
+        continue;
+
+      pid_t tid = static_cast<pid_t>(std::strtol(entry->d_name, nullptr, 10));
+      auto it = threads_.find(tid);
+      if (it == threads_.end()) {
+        std::string stat = std::string(entry->d_name) + "/stat";
+        int fd = openat(dirfd(taskDir_), stat.c_str(), O_RDONLY | O_CLOEXEC);
+        it = threads_.emplace(tid, Thread{fd, 0}).first;
+      }
+
+      Thread &thread = it->second;
+      if (thread.fd < 0)
+        continue;
+      uint64_t cpuMs = 0;
+      if (ReadCpuMs(thread.fd, cpuMs)) {
+        thread.cpuMs = cpuMs;
+        live++;
+      } else {
+        // Thread exited, keep its last sample
+        close(thread.fd);
+        thread.fd = -1;
+      }
+    }
+    peakThreads_ = std::max(peakThreads_, live);
+  }
+
+  uint32_t PeakThreads() const { return peakThreads_; }
+
+  // Last sampled CPU time of each thread seen, busiest first
+  std::vector<uint64_t> ThreadCpuMs() const {
+    std::vector<uint64_t> result;
+    for (const auto &entry : threads_) {
+      result.push_back(entry.second.cpuMs);
+    }
+    std::sort(result.rbegin(), result.rend());
+    return result;
+  }
+
+private:
+  struct Thread {
+    int fd;
+    uint64_t cpuMs;
+  };
+
+  DIR *taskDir_ = nullptr;
+  std::map<pid_t, Thread> threads_;
+  uint32_t peakThreads_ = 0;
+
+  static bool ReadCpuMs(int fd, uint64_t &cpuMs) {
+    char buf[1024];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0)
+      return false;
+    buf[n] = '\0';
+
+    // comm may contain spaces and parentheses, so parse after the last ')'
+    const char *rest = strrchr(buf, ')');
+    if (!rest)
+      return false;
+    unsigned long utime = 0, stime = 0;
+    if (sscanf(rest + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+               &utime, &stime) != 2)
+      return false;
+
+    static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    cpuMs = (static_cast<uint64_t>(utime) + stime) * 1000 / ticksPerSecond;
+    return true;
+  }
+};
+
 // AsyncWorker for waiting on process completion
 
 struct SharedStopState {
   int stopEventFd = -1;
+  int pidfd = -1;
   std::mutex mutex;
   bool closed = false;
 
-  SharedStopState() { stopEventFd = eventfd(0, EFD_NONBLOCK); }
+  explicit SharedStopState(pid_t pid) {
+    stopEventFd = eventfd(0, EFD_NONBLOCK);
+    pidfd = pidfd_open(pid, 0);
+  }
 
   ~SharedStopState() {
     if (stopEventFd >= 0) {
       close(stopEventFd);
       stopEventFd = -1;
     }
+    if (pidfd >= 0) {
+      close(pidfd);
+      pidfd = -1;
+    }
   }
 
-  // Called by worker when it's done
+  // Called by worker when it's done, before reaping the process
   void Close() {
     std::lock_guard<std::mutex> lock(mutex);
     closed = true;
+    if (pidfd >= 0) {
+      close(pidfd);
+      pidfd = -1;
+    }
+  }
+
+  bool IsClosed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return closed;
   }
 
   // Called by JS 'cancel' function
@@ -62,31 +195,207 @@ struct SharedStopState {
 
     uint64_t val = 1;
     ssize_t ret = write(stopEventFd, &val, sizeof(val));
+
+    // Kill right away rather than when the worker wakes up, which is late
+    // while every threadpool thread is busy monitoring another run. The
+    // worker still sees the stop first, since the eventfd is already set.
+    if (pidfd >= 0)
+      pidfd_send_signal(pidfd, SIGKILL, nullptr, 0);
     return (ret == sizeof(val));
   }
 };
 
+// Runs that JS stops together, like a file's testcases or a stress session.
+// Members are dropped once their worker is done.
+struct CancelGroup {
+  std::mutex mutex;
+  std::vector<std::weak_ptr<SharedStopState>> members;
+
+  void Add(std::shared_ptr<SharedStopState> state) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Prune();
+    members.push_back(state);
+  }
+
+  // Stops every member still running and returns how many there were
+  uint32_t Cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t stopped = 0;
+    for (auto &member : members) {
+      auto state = member.lock();
+      if (state && state->SignalStop())
+        stopped++;
+    }
+    Prune();
+    return stopped;
+  }
+
+private:
+  void Prune() {
+    members.erase(std::remove_if(members.begin(), members.end(),
+                                 [](const std::weak_ptr<SharedStopState> &m) {
+                                   auto state = m.lock();
+                                   return !state || state->IsClosed();
+                                 }),
+                  members.end());
+  }
+};
+
+// A solution started under linux-forkserver-shim.so. Its children are not ours,
+// so the server reaps them and reports their exit status and rusage.
+struct ForkServerState {
+  pid_t pid = -1;
+  int controlFd = -1;
+  std::atomic<bool> busy{false}; // a child is running
+  std::atomic<bool> closed{false};
+
+  ~ForkServerState() {
+    Close();
+    if (controlFd >= 0)
+      close(controlFd);
+  }
+
+  // Stops the server. The fd itself stays open until no worker can be reading
+  // from it; shutting it down wakes them up instead.
+  void Close() {
+    if (closed.exchange(true) || pid <= 0)
+      return;
+    shutdown(controlFd, SHUT_RDWR);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+  }
+
+  bool ReadExit(int &status, struct rusage &rusage) {
+    ForkServerExit report;
+    ssize_t n;
+    do {
+      n = recv(controlFd, &report, sizeof(report), 0);
+    } while (n < 0 && errno == EINTR);
+    busy = false;
+    if (n != sizeof(report))
+      return false;
+    status = report.status;
+    rusage = report.usage;
+    return true;
+  }
+};
+
 // AsyncWorker for waiting on process completion
 class WaitForProcessWorker : public Napi::AsyncWorker {
 public:
   WaitForProcessWorker(Napi::Env &env, pid_t pid, uint32_t timeoutMs,
-                       uint64_t memoryLimitBytes,
-                       std::shared_ptr<SharedStopState> sharedState)
+                       uint64_t memoryLimitBytes, bool wallTimeLimit,
+                       std::chrono::steady_clock::time_point startTime,
+                       std::shared_ptr<SharedStopState> sharedState,
+                       std::shared_ptr<ForkServerState> forkServer = nullptr)
       : Napi::AsyncWorker(env), pid_(pid), timeoutMs_(timeoutMs),
-        memoryLimitBytes_(memoryLimitBytes), deferred_(env), elapsedMs_(0.0),
-        peakMemoryBytes_(0), exitCode_(0), termSignal_(0), timedOut_(false),
-        memoryLimitExceeded_(false), stopped_(false), errorMsg_(""),
-        sharedState_(sharedState) {}
+        memoryLimitBytes_(memoryLimitBytes), wallTimeLimit_(wallTimeLimit),
+        startTime_(startTime), deferred_(env), elapsedMs_(0.0), cpuMs_(0.0),
+        wallMs_(0.0), peakMemoryBytes_(0), hugePageBytes_(0), exitCode_(0),
+        termSignal_(0),
+        timedOut_(false), memoryLimitExceeded_(false), stopped_(false),
+        errorMsg_(""), sharedState_(sharedState), forkServer_(forkServer),
+        threads_(pid) {}
 
   ~WaitForProcessWorker() {
-
-    // no-op, shared state destructor handles fd
+    // Only if the worker never ran, e.g. on teardown. Don't leave the thread
+    // watching a process nobody waits for.
+    if (monitor_.joinable()) {
+      sharedState_->SignalStop();
+      monitor_.join();
+    }
   }
 
   Napi::Promise GetPromise() { return deferred_.Promise(); }
 
+  // Starts watching the process on its own thread, right after spawn. The
+  // worker itself may wait for a free threadpool thread behind other runs, and
+  // that wait must not leave the process unwatched or count as its wall time.
+  void Start() {
+    try {
+      monitor_ = std::thread([this] { Monitor(); });
+    } catch (const std::system_error &) {
+      // Watched from Execute instead
+    }
+  }
+
 protected:
   void Execute() override {
+    if (monitor_.joinable()) {
+      monitor_.join();
+    } else {
+      Monitor();
+    }
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+
+    if (!errorMsg_.empty()) {
+      deferred_.Reject(Napi::Error::New(env, errorMsg_).Value());
+      return;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("elapsedMs", Napi::Number::New(env, elapsedMs_));
+    result.Set("cpuMs", Napi::Number::New(env, cpuMs_));
+    result.Set("wallMs", Napi::Number::New(env, wallMs_));
+    result.Set("threadCount", Napi::Number::New(env, threads_.PeakThreads()));
+    std::vector<uint64_t> threadCpuMs = threads_.ThreadCpuMs();
+    Napi::Array threadCpuArray = Napi::Array::New(env, threadCpuMs.size());
+    for (size_t i = 0; i < threadCpuMs.size(); i++) {
+      threadCpuArray.Set(
+          static_cast<uint32_t>(i),
+          Napi::Number::New(env, static_cast<double>(threadCpuMs[i])));
+    }
+    result.Set("threadCpuMs", threadCpuArray);
+    result.Set("peakMemoryBytes",
+               Napi::Number::New(env, static_cast<double>(peakMemoryBytes_)));
+    result.Set("hugePageBytes",
+               Napi::Number::New(env, static_cast<double>(hugePageBytes_)));
+
+    if (termSignal_ > 0) {
+      result.Set("exitCode", env.Null());
+    } else {
+      result.Set("exitCode", Napi::Number::New(env, exitCode_));
+    }
+
+    result.Set("timedOut", Napi::Boolean::New(env, timedOut_));
+    result.Set("memoryLimitExceeded",
+               Napi::Boolean::New(env, memoryLimitExceeded_));
+    result.Set("stopped", Napi::Boolean::New(env, stopped_));
+
+    deferred_.Resolve(result);
+  }
+
+  void OnError(const Napi::Error &e) override { deferred_.Reject(e.Value()); }
+
+private:
+  pid_t pid_;
+  uint32_t timeoutMs_;
+  uint64_t memoryLimitBytes_;
+  bool wallTimeLimit_;
+  std::chrono::steady_clock::time_point startTime_;
+  Napi::Promise::Deferred deferred_;
+  double elapsedMs_; // time charged against the limit
+  double cpuMs_;
+  double wallMs_;
+  uint64_t peakMemoryBytes_;
+  uint64_t hugePageBytes_; // peak anonymous memory backed by huge pages
+  int exitCode_;
+  int termSignal_;
+  bool timedOut_;
+  bool memoryLimitExceeded_;
+  bool stopped_;
+  std::string errorMsg_;
+  std::shared_ptr<SharedStopState> sharedState_;
+  std::shared_ptr<ForkServerState> forkServer_;
+  ThreadSampler threads_;
+  std::thread monitor_;
+
+  // Waits for the process while enforcing its limits, then collects its
+  // status and usage
+  void Monitor() {
     int status = 0;
     struct rusage rusage;
 
@@ -101,6 +410,10 @@ protected:
       } else {
         errorMsg_ = "pidfd_open failed (requires Linux 5.3+): ";
         errorMsg_ += std::strerror(errno);
+        if (forkServer_) {
+          kill(pid_, SIGKILL);
+          forkServer_->ReadExit(status, rusage);
+        }
         return;
       }
     }
@@ -115,7 +428,7 @@ protected:
       pfds[1].events = POLLIN;
 
       // We loop to implement polling for memory limits
-      auto startTime = std::chrono::steady_clock::now();
+      uint32_t iteration = 0;
 
       while (true) {
         // Calculate remaining timeout if applicable
@@ -137,6 +450,10 @@ protected:
           close(pidfd);
           errorMsg_ = "poll failed: ";
           errorMsg_ += std::strerror(errno);
+          if (forkServer_) {
+            kill(pid_, SIGKILL);
+            forkServer_->ReadExit(status, rusage);
+          }
           return;
         }
 
@@ -158,6 +475,13 @@ protected:
 
         // Timeout or Interval Wakeup - CHECK MEMORY/CPU TIME/TIMEOUT
 
+        // Threads are sampled every 50ms, which is plenty for reporting. So
+        // are huge pages, whose smaps walk costs more than reading VmHWM.
+        if (iteration++ % 5 == 0) {
+          threads_.Sample();
+          hugePageBytes_ = std::max(hugePageBytes_, GetHugePageBytes());
+        }
+
         // Check Memory
         long peakRSS = GetPeakRSS();
 
@@ -176,7 +500,7 @@ protected:
         }
 
         // Check CPU Time Limit
-        if (timeoutMs_ > 0) {
+        if (timeoutMs_ > 0 && !wallTimeLimit_) {
           uint64_t currentCpuTimeMs = GetCurrentCpuTimeMs();
           if (currentCpuTimeMs > timeoutMs_) {
             timedOut_ = true;
@@ -186,14 +510,16 @@ protected:
           }
         }
 
-        // Check Wall Clock Timeout (fallback safety mechanism)
+        // Check Wall Clock Timeout: the limit itself in wall time mode,
+        // otherwise a fallback safety mechanism with 2x leniency
         if (timeoutMs_ > 0) {
           auto now = std::chrono::steady_clock::now();
           auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                             now - startTime)
+                             now - startTime_)
                              .count();
-          // 2x leniency for wall clock vs CPU time
-          if (elapsed > (long)timeoutMs_ * 2) {
+          long wallLimit =
+              wallTimeLimit_ ? (long)timeoutMs_ : (long)timeoutMs_ * 2;
+          if (elapsed > wallLimit) {
             timedOut_ = true;
             kill(pid_, SIGKILL);
             close(pidfd);
@@ -203,12 +529,22 @@ protected:
       }
     }
 
+    wallMs_ = std::round(
+        std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startTime_)
+            .count());
+
     // Mark shared state as closed so cancel() becomes no-op
     sharedState_->Close();
 
     // Collect exit status and resource usage
     std::memset(&rusage, 0, sizeof(rusage));
-    if (wait4(pid_, &status, 0, &rusage) == -1) {
+    if (forkServer_) {
+      if (!forkServer_->ReadExit(status, rusage)) {
+        errorMsg_ = "Fork server exited unexpectedly";
+        return;
+      }
+    } else if (wait4(pid_, &status, 0, &rusage) == -1) {
       // Proceed with zeroed rusage
     }
 
@@ -216,10 +552,11 @@ protected:
     uint64_t cpuUs =
         (rusage.ru_utime.tv_sec + rusage.ru_stime.tv_sec) * 1000000ULL +
         (rusage.ru_utime.tv_usec + rusage.ru_stime.tv_usec);
-    elapsedMs_ = std::round(static_cast<double>(cpuUs) / 1000.0);
+    cpuMs_ = std::round(static_cast<double>(cpuUs) / 1000.0);
+    elapsedMs_ = wallTimeLimit_ ? wallMs_ : cpuMs_;
 
-    // Post-mortem CPU Time Check: Catch CPU time that exceeded limit between
-    // poll intervals or if process ended naturally just before detection
+    // Post-mortem Time Check: Catch time that exceeded limit between poll
+    // intervals or if process ended naturally just before detection
     if (timeoutMs_ > 0 && elapsedMs_ > timeoutMs_) {
       timedOut_ = true;
     }
@@ -245,7 +582,7 @@ protected:
 
         // Check for timeout: if CPU time is close to the limit, it was likely
         // timeout
-        if (timeoutMs_ > 0) {
+        if (timeoutMs_ > 0 && !wallTimeLimit_) {
           rlim_t limitSeconds = (timeoutMs_ + 999) / 1000;
           double cpuSeconds = elapsedMs_ / 1000.0;
           // If CPU time is within 90% of limit, consider it a timeout
@@ -275,50 +612,6 @@ protected:
     }
   }
 
-  void OnOK() override {
-    Napi::Env env = Env();
-
-    if (!errorMsg_.empty()) {
-      deferred_.Reject(Napi::Error::New(env, errorMsg_).Value());
-      return;
-    }
-
-    Napi::Object result = Napi::Object::New(env);
-    result.Set("elapsedMs", Napi::Number::New(env, elapsedMs_));
-    result.Set("peakMemoryBytes",
-               Napi::Number::New(env, static_cast<double>(peakMemoryBytes_)));
-
-    if (termSignal_ > 0) {
-      result.Set("exitCode", env.Null());
-    } else {
-      result.Set("exitCode", Napi::Number::New(env, exitCode_));
-    }
-
-    result.Set("timedOut", Napi::Boolean::New(env, timedOut_));
-    result.Set("memoryLimitExceeded",
-               Napi::Boolean::New(env, memoryLimitExceeded_));
-    result.Set("stopped", Napi::Boolean::New(env, stopped_));
-
-    deferred_.Resolve(result);
-  }
-
-  void OnError(const Napi::Error &e) override { deferred_.Reject(e.Value()); }
-
-private:
-  pid_t pid_;
-  uint32_t timeoutMs_;
-  uint64_t memoryLimitBytes_;
-  Napi::Promise::Deferred deferred_;
-  double elapsedMs_;
-  uint64_t peakMemoryBytes_;
-  int exitCode_;
-  int termSignal_;
-  bool timedOut_;
-  bool memoryLimitExceeded_;
-  bool stopped_;
-  std::string errorMsg_;
-  std::shared_ptr<SharedStopState> sharedState_;
-
   long GetPeakRSS() {
     std::string path = "/proc/" + std::to_string(pid_) + "/status";
     FILE *f = fopen(path.c_str(), "r");
@@ -340,6 +633,27 @@ private:
     return hwm;
   }
 
+  uint64_t GetHugePageBytes() {
+    std::string path = "/proc/" + std::to_string(pid_) + "/smaps_rollup";
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f)
+      return 0;
+
+    char line[256];
+    uint64_t bytes = 0;
+    while (fgets(line, sizeof(line), f)) {
+      if (strncmp(line, "AnonHugePages:", 14) == 0) {
+        unsigned long kb;
+        if (sscanf(line + 14, "%lu", &kb) == 1) {
+          bytes = static_cast<uint64_t>(kb) * 1024;
+        }
+        break;
+      }
+    }
+    fclose(f);
+    return bytes;
+  }
+
   uint64_t GetCurrentCpuTimeMs() {
     std::string path = "/proc/" + std::to_string(pid_) + "/stat";
     FILE *f = fopen(path.c_str(), "r");
@@ -380,6 +694,69 @@ std::vector<std::string> ToArgv(Napi::Array args) {
   return argv;
 }
 
+// Connects to one of the Unix Domain Sockets Runnable listens on for stdio.
+// Runs in the vfork child too, so it only makes async-signal-safe calls.
+int ConnectSocket(const char *path) {
+  int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0)
+    return -1;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+// The group behind a cancelGroup option, or null
+std::shared_ptr<CancelGroup> ToCancelGroup(Napi::Value value) {
+  if (!value.IsObject())
+    return nullptr;
+  Napi::Value handle = value.As<Napi::Object>().Get("handle");
+  if (!handle.IsExternal())
+    return nullptr;
+  return *handle.As<Napi::External<std::shared_ptr<CancelGroup>>>().Data();
+}
+
+// Starts monitoring a spawned process and returns its handle for JS
+Napi::Object MonitorProcess(Napi::Env env, pid_t pid, uint32_t timeoutMs,
+                            uint64_t memoryLimitBytes, bool wallTimeLimit,
+                            std::chrono::steady_clock::time_point startTime,
+                            std::shared_ptr<ForkServerState> forkServer,
+                            std::shared_ptr<CancelGroup> cancelGroup) {
+  auto sharedState = std::make_shared<SharedStopState>(pid);
+  if (cancelGroup)
+    cancelGroup->Add(sharedState);
+
+  // Start monitoring immediataely
+  auto worker =
+      new WaitForProcessWorker(env, pid, timeoutMs, memoryLimitBytes,
+                               wallTimeLimit, startTime, sharedState, forkServer);
+  auto promise = worker->GetPromise();
+  worker->Start();
+  worker->Queue();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("pid", Napi::Number::New(env, pid));
+  result.Set("result", promise);
+
+  // Expose cancel function
+  // We capture sharedState by value (shared_ptr copy) in the lambda
+  result.Set("cancel", Napi::Function::New(
+                           env,
+                           [sharedState](const Napi::CallbackInfo &info) {
+                             sharedState->SignalStop();
+                           },
+                           "cancel"));
+
+  return result;
+}
+
 // Spawns a process with native resource limits
 // Arguments:
 // 0: command (string)
@@ -391,6 +768,17 @@ std::vector<std::string> ToArgv(Napi::Array args) {
 // 6: pipeNameOut (string)
 // 7: pipeNameErr (string)
 // 8: onSpawn (function)
+// 9: options (object, optional)
+//    - cpuAffinity (number): pin the process to this CPU index, -1 to disable
+//    - timeLimitMode ("cpu" | "wall"): which time timeoutMs limits, default
+//      "cpu"
+//    - env (array of "KEY=VALUE" strings): the child's whole environment,
+//      inherited from this process when absent
+//    - transparentHugePages ("never"): disable transparent huge pages for the
+//      child with PR_SET_THP_DISABLE, which survives exec. Anything else
+//      keeps the system policy.
+//    - cancelGroup (object from createCancelGroup): stop the child along with
+//      the rest of the group
 // Returns: { pid: number, result: Promise<AddonResult> }
 //
 Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
@@ -416,10 +804,41 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
 
   Napi::Function onSpawn = info[8].As<Napi::Function>();
 
+  int cpuAffinity = -1;
+  bool wallTimeLimit = false;
+  bool disableHugePages = false;
+  bool customEnv = false;
+  std::vector<std::string> envStrings;
+  std::shared_ptr<CancelGroup> cancelGroup;
+  if (info.Length() > 9 && info[9].IsObject()) {
+    Napi::Object options = info[9].As<Napi::Object>();
+    Napi::Value affinity = options.Get("cpuAffinity");
+    if (affinity.IsNumber()) {
+      cpuAffinity = affinity.As<Napi::Number>().Int32Value();
+    }
+    wallTimeLimit = ToString(options.Get("timeLimitMode")) == "wall";
+    disableHugePages =
+        ToString(options.Get("transparentHugePages")) == "never";
+    cancelGroup = ToCancelGroup(options.Get("cancelGroup"));
+    Napi::Value envValue = options.Get("env");
+    if (envValue.IsArray()) {
+      customEnv = true;
+      envStrings = ToArgv(envValue.As<Napi::Array>());
+    }
+  }
+
   // Pre-convert JS values to C++ strings/vectors in the parent process.
   // DO NOT access 'info', 'argsArray' in the child process after fork().
   std::vector<std::string> args = ToArgv(argsArray);
 
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  if (cpuAffinity >= 0 && cpuAffinity < CPU_SETSIZE) {
+    CPU_SET(cpuAffinity, &cpuSet);
+  } else {
+    cpuAffinity = -1;
+  }
+
   std::vector<char *> argv;
   argv.push_back(const_cast<char *>(command.c_str()));
   for (auto &arg : args) {
@@ -427,6 +846,13 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   }
   argv.push_back(nullptr);
 
+  // Built before vfork, since the child must not allocate
+  std::vector<char *> envp;
+  for (auto &entry : envStrings) {
+    envp.push_back(const_cast<char *>(entry.c_str()));
+  }
+  envp.push_back(nullptr);
+
   // Create a pipe to communicate errors from child to parent
   int err_pipe[2];
   if (pipe2(err_pipe, O_CLOEXEC) == -1) {
@@ -435,6 +861,12 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
     return env.Null();
   }
 
+  // The vfork child shares this process's mm until it execs, so disabling
+  // huge pages there disables them here too. Remember the flag to put it back.
+  int parentHugePagesDisabled =
+      disableHugePages ? prctl(PR_GET_THP_DISABLE, 0, 0, 0, 0) : 0;
+
+  auto startTime = std::chrono::steady_clock::now();
   pid_t pid = vfork();
 
   if (pid < 0) {
@@ -448,30 +880,12 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   if (pid == 0) {
     // Child process (Caution: shares memory with parent until exec)
 
-    // Connect to Unix Domain Sockets for stdio
-    auto connectSocket = [](const char *path) -> int {
-      int sock = socket(AF_UNIX, SOCK_STREAM, 0);
-      if (sock < 0)
-        return -1;
-
-      struct sockaddr_un addr;
-      memset(&addr, 0, sizeof(addr));
-      addr.sun_family = AF_UNIX;
-      strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
-
-      if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(sock);
-        return -1;
-      }
-      return sock;
-    };
-
     // Stdin: Read from socket (from parent)
-    int sockIn = connectSocket(pipeNameIn.c_str());
+    int sockIn = ConnectSocket(pipeNameIn.c_str());
     // Stdout: Write to socket (to parent)
-    int sockOut = connectSocket(pipeNameOut.c_str());
+    int sockOut = ConnectSocket(pipeNameOut.c_str());
     // Stderr: Write to socket (to parent)
-    int sockErr = connectSocket(pipeNameErr.c_str());
+    int sockErr = ConnectSocket(pipeNameErr.c_str());
 
     if (sockIn < 0 || sockOut < 0 || sockErr < 0) {
       // Avoid printf/perror in vfork child if possible, or keep it minimal
@@ -492,13 +906,27 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
     // Resource limits are now handled in the monitoring loop
     // (removed prlimit for CPU time as it only works with second precision)
 
+    // Best effort: an offline CPU leaves the process unpinned
+    if (cpuAffinity >= 0) {
+      sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+    }
+
+    // Copied into the new mm by exec
+    if (disableHugePages) {
+      prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0);
+    }
+
     // Change directory
     if (!cwd.empty()) {
       chdir(cwd.c_str());
     }
 
-    // Execute
-    execvp(command.c_str(), argv.data());
+    // Execute. PATH is still looked up in this process's environment.
+    if (customEnv) {
+      execvpe(command.c_str(), argv.data(), envp.data());
+    } else {
+      execvp(command.c_str(), argv.data());
+    }
 
     // If exec fails, communicate errno to parent
     int err = errno;
@@ -507,6 +935,9 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   }
 
   // Parent process
+  if (disableHugePages && parentHugePagesDisabled == 0) {
+    prctl(PR_SET_THP_DISABLE, 0, 0, 0, 0);
+  }
   close(err_pipe[1]); // Close write end in parent
 
   // Check if child reported an error
@@ -525,32 +956,388 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   // Notify JS that the process has spawned
   onSpawn.Call({});
 
-  auto sharedState = std::make_shared<SharedStopState>();
+  return MonitorProcess(env, pid, timeoutMs, memoryLimitBytes, wallTimeLimit,
+                        startTime, nullptr, cancelGroup);
+}
 
-  // Start monitoring immediataely
-  auto worker = new WaitForProcessWorker(env, pid, timeoutMs, memoryLimitBytes,
-                                         sharedState);
+// Runs one child of a fork server. Limits and accounting are the same as
+// spawn's, only the exit status and rusage come from the server.
+// Arguments:
+// 0: timeoutMs (number)
+// 1: memoryLimitMB (number)
+// 2: pipeNameIn (string)
+// 3: pipeNameOut (string)
+// 4: pipeNameErr (string)
+// 5: onSpawn (function)
+// 6: options (object, optional): cpuAffinity, timeLimitMode and cancelGroup as
+//    in spawn.
+//    The environment was fixed when the server started.
+// Returns: { pid: number, result: Promise<AddonResult> }
+//
+Napi::Value ForkServerSpawn(const Napi::CallbackInfo &info,
+                            std::shared_ptr<ForkServerState> server) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 6) {
+    Napi::TypeError::New(env, "Expected 6 arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint32_t timeoutMs = info[0].As<Napi::Number>().Uint32Value();
+  double memoryLimitMB = info[1].As<Napi::Number>().DoubleValue();
+  uint64_t memoryLimitBytes =
+      static_cast<uint64_t>(memoryLimitMB * 1024.0 * 1024.0);
+  std::string pipeNameIn = ToString(info[2]);
+  std::string pipeNameOut = ToString(info[3]);
+  std::string pipeNameErr = ToString(info[4]);
+  Napi::Function onSpawn = info[5].As<Napi::Function>();
+
+  ForkServerRequest request = {-1};
+  bool wallTimeLimit = false;
+  std::shared_ptr<CancelGroup> cancelGroup;
+  if (info.Length() > 6 && info[6].IsObject()) {
+    Napi::Object options = info[6].As<Napi::Object>();
+    Napi::Value affinity = options.Get("cpuAffinity");
+    if (affinity.IsNumber()) {
+      request.cpuAffinity = affinity.As<Napi::Number>().Int32Value();
+    }
+    wallTimeLimit = ToString(options.Get("timeLimitMode")) == "wall";
+    cancelGroup = ToCancelGroup(options.Get("cancelGroup"));
+  }
+
+  if (server->closed) {
+    Napi::Error::New(env, "Fork server is closed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (server->busy.exchange(true)) {
+    Napi::Error::New(env, "Fork server is already running a child")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int fds[3] = {ConnectSocket(pipeNameIn.c_str()),
+                ConnectSocket(pipeNameOut.c_str()),
+                ConnectSocket(pipeNameErr.c_str())};
+  auto closeFds = [&fds]() {
+    for (int fd : fds) {
+      if (fd >= 0)
+        close(fd);
+    }
+  };
+  if (fds[0] < 0 || fds[1] < 0 || fds[2] < 0) {
+    int err = errno;
+    closeFds();
+    server->busy = false;
+    Napi::Error::New(env, "Failed to connect stdio: " +
+                              std::string(std::strerror(err)))
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // The stdio sockets travel to the server as SCM_RIGHTS
+  char control[CMSG_SPACE(sizeof(fds))];
+  std::memset(control, 0, sizeof(control));
+  struct iovec iov = {&request, sizeof(request)};
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  auto startTime = std::chrono::steady_clock::now();
+  ssize_t n;
+  do {
+    n = sendmsg(server->controlFd, &msg, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  closeFds();
+
+  // The server answers right after fork, so this doesn't block for long
+  ForkServerSpawned spawned = {-1, 0};
+  if (n == sizeof(request)) {
+    do {
+      n = recv(server->controlFd, &spawned, sizeof(spawned), 0);
+    } while (n < 0 && errno == EINTR);
+  }
+  if (n != sizeof(spawned)) {
+    server->Close();
+    server->busy = false;
+    Napi::Error::New(env, "Fork server exited unexpectedly")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (spawned.pid < 0) {
+    server->busy = false;
+    Napi::Error::New(env, "fork failed: " +
+                              std::string(std::strerror(spawned.error)))
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  onSpawn.Call({});
+
+  return MonitorProcess(env, spawned.pid, timeoutMs, memoryLimitBytes,
+                        wallTimeLimit, startTime, server, cancelGroup);
+}
+
+// AsyncWorker waiting for a fork server to reach main
+class WaitForForkServerWorker : public Napi::AsyncWorker {
+public:
+  WaitForForkServerWorker(Napi::Env &env,
+                          std::shared_ptr<ForkServerState> server)
+      : Napi::AsyncWorker(env), deferred_(env), server_(server) {}
+
+  Napi::Promise GetPromise() { return deferred_.Promise(); }
+
+protected:
+  void Execute() override {
+    // Generous, since static initializers run before the hello
+    static const int startTimeoutMs = 10000;
+
+    struct pollfd pfd = {server_->controlFd, POLLIN, 0};
+    int ready;
+    do {
+      ready = poll(&pfd, 1, startTimeoutMs);
+    } while (ready < 0 && errno == EINTR);
+
+    ForkServerSpawned hello;
+    ssize_t n = -1;
+    if (ready > 0) {
+      n = recv(server_->controlFd, &hello, sizeof(hello), 0);
+    }
+    if (n == sizeof(hello))
+      return;
+
+    if (ready == 0) {
+      errorMsg_ = "Fork server did not reach main in time";
+    } else {
+      // The loader ignores LD_PRELOAD for static binaries, which then run
+      // main with no input and exit
+      errorMsg_ = "Program exited without starting a fork server, it must be "
+                  "dynamically linked";
+    }
+    server_->Close();
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+
+    if (!errorMsg_.empty()) {
+      deferred_.Reject(Napi::Error::New(env, errorMsg_).Value());
+      return;
+    }
+
+    std::shared_ptr<ForkServerState> server = server_;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("pid", Napi::Number::New(env, server->pid));
+    result.Set("spawn",
+               Napi::Function::New(
+                   env,
+                   [server](const Napi::CallbackInfo &info) {
+                     return ForkServerSpawn(info, server);
+                   },
+                   "spawn"));
+    result.Set("close", Napi::Function::New(
+                            env,
+                            [server](const Napi::CallbackInfo &info) {
+                              server->Close();
+                            },
+                            "close"));
+    deferred_.Resolve(result);
+  }
+
+  void OnError(const Napi::Error &e) override { deferred_.Reject(e.Value()); }
+
+private:
+  Napi::Promise::Deferred deferred_;
+  std::shared_ptr<ForkServerState> server_;
+  std::string errorMsg_;
+};
+
+// Starts a program under linux-forkserver-shim.so, which stops it right
+// before main and forks a child from there for every spawn. Its stdio is
+// /dev/null until then.
+// Arguments:
+// 0: command (string)
+// 1: args (array of strings)
+// 2: cwd (string) or empty
+// 3: shimPath (string)
+// 4: options (object, optional)
+//    - env (array of "KEY=VALUE" strings): the program's whole environment,
+//      inherited from this process when absent
+// Returns: Promise<{ pid: number, spawn: function, close: function }>
+//
+Napi::Value StartForkServer(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 4) {
+    Napi::TypeError::New(env, "Expected 4 arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string command = ToString(info[0]);
+  std::vector<std::string> args = ToArgv(info[1].As<Napi::Array>());
+  std::string cwd = ToString(info[2]);
+  std::string shimPath = ToString(info[3]);
+
+  std::vector<std::string> envStrings;
+  if (info.Length() > 4 && info[4].IsObject() &&
+      info[4].As<Napi::Object>().Get("env").IsArray()) {
+    envStrings = ToArgv(info[4].As<Napi::Object>().Get("env").As<Napi::Array>());
+  } else {
+    for (char **entry = environ; *entry; entry++) {
+      envStrings.push_back(*entry);
+    }
+  }
+
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) == -1) {
+    Napi::Error::New(env,
+                     "socketpair failed: " + std::string(std::strerror(errno)))
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Keep any preloads the user already has after the shim
+  std::string preload = "LD_PRELOAD=" + shimPath;
+  std::string controlFdEntry = FOC_FORKSERVER_FD_ENV "=" + std::to_string(sv[1]);
+  std::vector<std::string> serverEnv;
+  for (auto &entry : envStrings) {
+    if (entry.rfind("LD_PRELOAD=", 0) == 0) {
+      if (entry.size() > 11)
+        preload += ":" + entry.substr(11);
+    } else if (entry.rfind(FOC_FORKSERVER_FD_ENV "=", 0) != 0) {
+      serverEnv.push_back(entry);
+    }
+  }
+  serverEnv.push_back(preload);
+  serverEnv.push_back(controlFdEntry);
+
+  // Built before vfork, since the child must not allocate
+  std::vector<char *> argv;
+  argv.push_back(const_cast<char *>(command.c_str()));
+  for (auto &arg : args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  std::vector<char *> envp;
+  for (auto &entry : serverEnv) {
+    envp.push_back(const_cast<char *>(entry.c_str()));
+  }
+  envp.push_back(nullptr);
+
+  int err_pipe[2];
+  if (pipe2(err_pipe, O_CLOEXEC) == -1) {
+    close(sv[0]);
+    close(sv[1]);
+    Napi::Error::New(env, "pipe2 failed: " + std::string(std::strerror(errno)))
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  pid_t pid = vfork();
+
+  if (pid < 0) {
+    close(sv[0]);
+    close(sv[1]);
+    close(err_pipe[0]);
+    close(err_pipe[1]);
+    Napi::Error::New(env, "vfork failed: " + std::string(std::strerror(errno)))
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (pid == 0) {
+    // Child process (Caution: shares memory with parent until exec)
+
+    // The control socket is the only fd the server inherits on purpose
+    fcntl(sv[1], F_SETFD, 0);
+
+    int devNull = open("/dev/null", O_RDWR);
+    if (devNull < 0 || dup2(devNull, STDIN_FILENO) < 0 ||
+        dup2(devNull, STDOUT_FILENO) < 0 || dup2(devNull, STDERR_FILENO) < 0) {
+      _exit(1);
+    }
+    if (devNull > STDERR_FILENO) {
+      close(devNull);
+    }
+
+    if (!cwd.empty()) {
+      chdir(cwd.c_str());
+    }
+
+    execvpe(command.c_str(), argv.data(), envp.data());
+
+    int err = errno;
+    write(err_pipe[1], &err, sizeof(err));
+    _exit(1);
+  }
+
+  // Parent process
+  close(sv[1]);
+  close(err_pipe[1]);
+
+  int childErr = 0;
+  ssize_t count = read(err_pipe[0], &childErr, sizeof(childErr));
+  close(err_pipe[0]);
+
+  if (count > 0) {
+    int status;
+    waitpid(pid, &status, 0);
+    close(sv[0]);
+    Napi::Error::New(env, std::strerror(childErr)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto server = std::make_shared<ForkServerState>();
+  server->pid = pid;
+  server->controlFd = sv[0];
+
+  auto worker = new WaitForForkServerWorker(env, server);
   auto promise = worker->GetPromise();
   worker->Queue();
+  return promise;
+}
 
-  Napi::Object result = Napi::Object::New(env);
-  result.Set("pid", Napi::Number::New(env, pid));
-  result.Set("result", promise);
+// Creates a group of runs that stop together. Pass it as spawn's cancelGroup
+// option, then cancel() kills every member still running in one call, from
+// this thread instead of through each member's worker.
+// Returns: { cancel: () => number, handle: External }
+//   cancel returns how many members were still running
+Napi::Value CreateCancelGroup(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  auto group = std::make_shared<CancelGroup>();
 
-  // Expose cancel function
-  // We capture sharedState by value (shared_ptr copy) in the lambda
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("handle",
+             Napi::External<std::shared_ptr<CancelGroup>>::New(
+                 env, new std::shared_ptr<CancelGroup>(group),
+                 [](Napi::Env, std::shared_ptr<CancelGroup> *handle) {
+                   delete handle;
+                 }));
   result.Set("cancel", Napi::Function::New(
                            env,
-                           [sharedState](const Napi::CallbackInfo &info) {
-                             sharedState->SignalStop();
+                           [group](const Napi::CallbackInfo &info) {
+                             return Napi::Number::New(info.Env(),
+                                                      group->Cancel());
                            },
                            "cancel"));
-
   return result;
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("spawn", Napi::Function::New(env, SpawnProcess, "spawn"));
+  exports.Set("startForkServer",
+              Napi::Function::New(env, StartForkServer, "startForkServer"));
+  exports.Set("createCancelGroup",
+              Napi::Function::New(env, CreateCancelGroup, "createCancelGroup"));
   return exports;
 }
 
@@ -1,9 +1,12 @@
 #include <Windows.h>
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <map>
 #include <napi.h>
 #include <psapi.h>
 #include <string>
+#include <tlhelp32.h>
 #include <vector>
 
 #pragma comment(lib, "psapi.lib")
@@ -73,16 +76,83 @@ std::string GetErrorMessage(DWORD errorCode) {
   return message + " (Error Code: " + std::to_string(errorCode) + ")";
 }
 
+// Samples the CPU time of every thread. Threads are discovered through a
+// Toolhelp snapshot and their handles stay open between samples, so a thread
+// that exits still reports its final CPU time. Threads that start and exit
+// between two samples are not seen.
+class ThreadSampler {
+public:
+  explicit ThreadSampler(DWORD pid) : pid_(pid) {}
+
+  ~ThreadSampler() {
+    for (auto &entry : threads_) {
+      if (entry.second != NULL)
+        CloseHandle(entry.second);
+    }
+  }
+
+  void Sample() {
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE)
+      return;
+
+    uint32_t live = 0;
+    THREADENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = Thread32First(snapshot, &entry); ok;
+         ok = Thread32Next(snapshot, &entry)) {
+      if (entry.th32OwnerProcessID != pid_)
+        continue;
+      live++;
+      if (threads_.find(entry.th32ThreadID) == threads_.end()) {
+        threads_[entry.th32ThreadID] = OpenThread(
+            THREAD_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ThreadID);
+      }
+    }
+    CloseHandle(snapshot);
+    peakThreads_ = std::max(peakThreads_, live);
+  }
+
+  uint32_t PeakThreads() const { return peakThreads_; }
+
+  // CPU time of each thread seen, busiest first
+  std::vector<uint64_t> ThreadCpuMs() const {
+    std::vector<uint64_t> result;
+    for (const auto &entry : threads_) {
+      FILETIME ftCreation, ftExit, ftKernel, ftUser;
+      if (entry.second == NULL ||
+          !GetThreadTimes(entry.second, &ftCreation, &ftExit, &ftKernel,
+                          &ftUser))
+        continue;
+      ULARGE_INTEGER kernel, user;
+      kernel.LowPart = ftKernel.dwLowDateTime;
+      kernel.HighPart = ftKernel.dwHighDateTime;
+      user.LowPart = ftUser.dwLowDateTime;
+      user.HighPart = ftUser.dwHighDateTime;
+      result.push_back((kernel.QuadPart + user.QuadPart) / 10000);
+    }
+    std::sort(result.rbegin(), result.rend());
+    return result;
+  }
+
+private:
+  DWORD pid_;
+  std::map<DWORD, HANDLE> threads_;
+  uint32_t peakThreads_ = 0;
+};
+
 class WaitForProcessWorker : public Napi::AsyncWorker {
 public:
   WaitForProcessWorker(Napi::Env &env, HANDLE hProcess, DWORD pid,
                        DWORD timeoutMs, uint64_t memoryLimitBytes,
+                       bool wallTimeLimit,
                        std::shared_ptr<SharedStopState> sharedState)
       : Napi::AsyncWorker(env), hProcess_(hProcess), pid_(pid),
         timeoutMs_(timeoutMs), memoryLimitBytes_(memoryLimitBytes),
-        deferred_(env), elapsedMs_(0.0), peakMemoryBytes_(0), exitCode_(0),
+        wallTimeLimit_(wallTimeLimit), deferred_(env), elapsedMs_(0.0),
+        cpuMs_(0.0), wallMs_(0.0), peakMemoryBytes_(0), exitCode_(0),
         timedOut_(false), memoryLimitExceeded_(false), stopped_(false),
-        errorMsg_(""), sharedState_(sharedState) {}
+        errorMsg_(""), sharedState_(sharedState), threads_(pid) {}
 
   ~WaitForProcessWorker() {
     if (hProcess_ != NULL) {
@@ -123,7 +193,7 @@ protected:
     jobLimits.BasicLimitInformation.LimitFlags = 0;
 
     // Set time limit if specified (in 100-nanosecond intervals)
-    if (timeoutMs_ > 0) {
+    if (timeoutMs_ > 0 && !wallTimeLimit_) {
       ULONGLONG timeLimit100ns = static_cast<ULONGLONG>(timeoutMs_) * 10000ULL;
       jobLimits.BasicLimitInformation.PerProcessUserTimeLimit.QuadPart =
           timeLimit100ns;
@@ -177,11 +247,13 @@ protected:
 
     // Wait loop for process to complete or be stopped externally
     // We poll to check for Total CPU Time (User + Kernel) and enforce Wall
-    // Clock limit (2x CPU limit)
+    // Clock limit (the limit itself in wall time mode, otherwise 2x CPU limit)
 
     DWORD startTime = GetTickCount();
     unsigned long long timeoutMsLong =
         static_cast<unsigned long long>(timeoutMs_);
+    DWORD wallLimitMs = wallTimeLimit_ ? timeoutMs_ : timeoutMs_ * 2;
+    uint32_t iteration = 0;
 
     // We keep the OS-level User Time limit (set above in jobLimits) as a
     // backup.
@@ -191,8 +263,8 @@ protected:
     while (!processExited && !stopped_) {
       DWORD elapsedWall = GetTickCount() - startTime;
 
-      // 1. Wall Clock Check (2x CPU Limit for leniency)
-      if (timeoutMs_ > 0 && elapsedWall >= timeoutMs_ * 2) {
+      // 1. Wall Clock Check
+      if (timeoutMs_ > 0 && elapsedWall >= wallLimitMs) {
         timedOut_ = true;
         stopped_ = true;
         break;
@@ -204,7 +276,7 @@ protected:
 
       if (timeoutMs_ > 0) {
         // Don't sleep past the hard wall limit
-        DWORD remaining = (timeoutMs_ * 2) - elapsedWall;
+        DWORD remaining = wallLimitMs - elapsedWall;
         if (remaining < slice)
           waitMillis = remaining;
       } else {
@@ -224,8 +296,13 @@ protected:
         stopped_ = true;
         break;
       } else if (waitResult == WAIT_TIMEOUT) {
+        // Threads are sampled every 50ms, which is plenty for reporting
+        if (iteration++ % 5 == 0) {
+          threads_.Sample();
+        }
+
         // Slice finished, check CPU usage
-        if (timeoutMs_ > 0) {
+        if (timeoutMs_ > 0 && !wallTimeLimit_) {
           JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accounting;
           if (QueryInformationJobObject(
                   hJob, JobObjectBasicAccountingInformation, &accounting,
@@ -346,9 +423,13 @@ protected:
     userTime.HighPart = ftUserFinal.dwHighDateTime;
     double rawElapsedMs =
         static_cast<double>(kernelTime.QuadPart + userTime.QuadPart) / 10000.0;
-    elapsedMs_ = std::round(rawElapsedMs);
+    cpuMs_ = std::round(rawElapsedMs);
+    wallMs_ = std::round(
+        static_cast<double>(exitTime.QuadPart - creationTime.QuadPart) /
+        10000.0);
+    elapsedMs_ = wallTimeLimit_ ? wallMs_ : cpuMs_;
 
-    // Post-mortem CPU Time Check
+    // Post-mortem Time Check
     if (timeoutMs_ > 0 && elapsedMs_ > timeoutMs_) {
       timedOut_ = true;
     }
@@ -364,6 +445,17 @@ protected:
     }
 
     result.Set("elapsedMs", Napi::Number::New(env, elapsedMs_));
+    result.Set("cpuMs", Napi::Number::New(env, cpuMs_));
+    result.Set("wallMs", Napi::Number::New(env, wallMs_));
+    result.Set("threadCount", Napi::Number::New(env, threads_.PeakThreads()));
+    std::vector<uint64_t> threadCpuMs = threads_.ThreadCpuMs();
+    Napi::Array threadCpuArray = Napi::Array::New(env, threadCpuMs.size());
+    for (size_t i = 0; i < threadCpuMs.size(); i++) {
+      threadCpuArray.Set(
+          static_cast<uint32_t>(i),
+          Napi::Number::New(env, static_cast<double>(threadCpuMs[i])));
+    }
+    result.Set("threadCpuMs", threadCpuArray);
     result.Set("peakMemoryBytes",
                Napi::Number::New(env, static_cast<double>(peakMemoryBytes_)));
 
@@ -390,8 +482,11 @@ private:
   DWORD pid_;
   DWORD timeoutMs_;
   uint64_t memoryLimitBytes_;
+  bool wallTimeLimit_;
   Napi::Promise::Deferred deferred_;
-  double elapsedMs_;
+  double elapsedMs_; // time charged against the limit
+  double cpuMs_;
+  double wallMs_;
   uint64_t peakMemoryBytes_;
   int exitCode_;
   bool timedOut_;
@@ -399,6 +494,7 @@ private:
   bool stopped_;
   std::string errorMsg_;
   std::shared_ptr<SharedStopState> sharedState_;
+  ThreadSampler threads_;
 };
 
 // Helper to convert UTF-8 string to UTF-16 wstring for Windows APIs
@@ -462,6 +558,12 @@ std::wstring QuoteArg(const std::wstring &arg) {
 // 6: pipeNameOut (string)
 // 7: pipeNameErr (string)
 // 8: onSpawn (function)
+// 9: options (object, optional)
+//    - cpuAffinity (number): pin the process to this CPU index, -1 to disable
+//    - timeLimitMode ("cpu" | "wall"): which time timeoutMs limits, default
+//      "cpu"
+//    - env (array of "KEY=VALUE" strings): the child's whole environment,
+//      inherited from this process when absent
 // Returns: { pid: number, result: Promise<AddonResult> }
 //
 Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
@@ -483,6 +585,33 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   std::string pipeNameErr = info[7].As<Napi::String>().Utf8Value();
   Napi::Function onSpawn = info[8].As<Napi::Function>();
 
+  int cpuAffinity = -1;
+  bool wallTimeLimit = false;
+  bool customEnv = false;
+  std::wstring envBlock;
+  if (info.Length() > 9 && info[9].IsObject()) {
+    Napi::Object options = info[9].As<Napi::Object>();
+    Napi::Value affinity = options.Get("cpuAffinity");
+    if (affinity.IsNumber()) {
+      cpuAffinity = affinity.As<Napi::Number>().Int32Value();
+    }
+    Napi::Value timeLimitMode = options.Get("timeLimitMode");
+    wallTimeLimit = timeLimitMode.IsString() &&
+                    timeLimitMode.As<Napi::String>().Utf8Value() == "wall";
+    Napi::Value envValue = options.Get("env");
+    if (envValue.IsArray()) {
+      customEnv = true;
+      Napi::Array envArray = envValue.As<Napi::Array>();
+      // Double null terminated block of null terminated "KEY=VALUE" strings
+      for (uint32_t i = 0; i < envArray.Length(); i++) {
+        envBlock +=
+            ToWString(envArray.Get(i).As<Napi::String>().Utf8Value());
+        envBlock.push_back(L'\0');
+      }
+      envBlock.push_back(L'\0');
+    }
+  }
+
   uint64_t memoryLimitBytes =
       static_cast<uint64_t>(memoryLimitMB * 1024.0 * 1024.0);
 
@@ -551,7 +680,8 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   BOOL success = CreateProcessW(NULL, &cmdLine[0], NULL, NULL, TRUE,
                                 CREATE_SUSPENDED | CREATE_UNICODE_ENVIRONMENT |
                                     CREATE_NO_WINDOW,
-                                NULL, lpCwd, &siStartInfo, &piProcInfo);
+                                customEnv ? &envBlock[0] : NULL, lpCwd,
+                                &siStartInfo, &piProcInfo);
 
   CloseHandle(hStdin);
   CloseHandle(hStdout);
@@ -571,6 +701,12 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   // limits, it avoids double-assignment errors and complexity sharing the
   // handle.
 
+  // Best effort: an invalid CPU index leaves the process unpinned
+  if (cpuAffinity >= 0 &&
+      cpuAffinity < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+    SetProcessAffinityMask(piProcInfo.hProcess, DWORD_PTR(1) << cpuAffinity);
+  }
+
   ResumeThread(piProcInfo.hThread);
   CloseHandle(piProcInfo.hThread);
 
@@ -587,8 +723,9 @@ Napi::Value SpawnProcess(const Napi::CallbackInfo &info) {
   auto sharedState = std::make_shared<SharedStopState>();
 
   // Start monitoring
-  auto worker = new WaitForProcessWorker(env, hProcessDup, pid, timeoutMs,
-                                         memoryLimitBytes, sharedState);
+  auto worker =
+      new WaitForProcessWorker(env, hProcessDup, pid, timeoutMs,
+                               memoryLimitBytes, wallTimeLimit, sharedState);
   auto promise = worker->GetPromise();
   worker->Queue();
 
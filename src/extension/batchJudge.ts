@@ -0,0 +1,267 @@
+import * as fs from "node:fs";
+import * as path from "node:path";
+import * as vscode from "vscode";
+
+import {
+  formatBytes,
+  getAllowedCpus,
+  getBenchmarkTestcases,
+  prepareVariant,
+  type BenchmarkLimits,
+  type BenchmarkTestcase,
+  type PreparedVariant,
+} from "./benchmark";
+import type JudgeViewProvider from "./providers/JudgeViewProvider";
+import { getLocalTimeLimit, getTimeMultiplier } from "./providers/JudgeViewProvider";
+import {
+  createScratchDirectory,
+  getMemoryPolicy,
+  getTimeLimitMode,
+  mapTestcaseTermination,
+  readScratchOutput,
+  removeScratchDirectory,
+  Runnable,
+} from "./utils/runtime";
+import { getFileRunSettings, openInNewEditor, TextHandler } from "./utils/vscode";
+import { getLogger } from "./utils/logging";
+import { waitForWorkerSlot } from "./utils/lagMonitor";
+import type { Status } from "../shared/enums";
+
+type TestcaseVerdict = {
+  status: Status;
+  elapsed: number;
+  memoryBytes: number;
+};
+
+type ProblemResult = {
+  file: string;
+  error?: string;
+  testcases: number;
+  verdicts: TestcaseVerdict[];
+};
+
+type BatchJob = {
+  problem: ProblemResult;
+  variant: PreparedVariant;
+  testcase: BenchmarkTestcase;
+  limits: BenchmarkLimits;
+  inputFile?: string;
+  outputFile?: string;
+};
+
+// Worst first, so a problem shows the most severe verdict among its testcases
+const VERDICT_ORDER: Status[] = ["CE", "RE", "ML", "TL", "WA", "NA", "AC"];
+
+async function judgeTestcase(job: BatchJob, cpuAffinity: number): Promise<TestcaseVerdict> {
+  const { variant, testcase, limits, inputFile, outputFile } = job;
+  let scratchDirectory: string | undefined;
+  if (inputFile || outputFile) {
+    try {
+      scratchDirectory = await createScratchDirectory(inputFile, testcase.stdin);
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      getLogger("judge").error(`Failed to prepare scratch directory: ${errorMessage}`);
+      return { status: "RE", elapsed: 0, memoryBytes: 0 };
+    }
+  }
+
+  const runnable = new Runnable();
+  const stdout = new TextHandler();
+  runnable
+    .on("spawn", () => runnable.stdin?.end(testcase.stdin))
+    .on("stdout:bytes", (data: Buffer) => stdout.write(data, "batch"))
+    .on("stdout:end", () => stdout.write("", "final"))
+    .run(
+      variant.runCommand,
+      limits.timeLimit,
+      limits.memoryLimit,
+      scratchDirectory ?? variant.cwd,
+      {
+        cpuAffinity,
+        timeLimitMode: getTimeLimitMode(),
+        runtimeProfile: variant.runtimeProfile,
+        memoryPolicy: getMemoryPolicy(),
+      }
+    );
+  await runnable.done;
+  void runnable.dispose();
+
+  let output = stdout.bytes;
+  if (scratchDirectory) {
+    if (outputFile) {
+      const fileOutput = new TextHandler();
+      fileOutput.write(await readScratchOutput(scratchDirectory, outputFile), "final");
+      output = fileOutput.bytes;
+    }
+    await removeScratchDirectory(scratchDirectory);
+  }
+
+  let status = mapTestcaseTermination(runnable.termination);
+  if (runnable.termination === "exit" && testcase.acceptedStdout.trim() !== "") {
+    status = output.equals(Buffer.from(testcase.acceptedStdout)) ? "AC" : "WA";
+  }
+  return { status, elapsed: runnable.elapsed, memoryBytes: runnable.maxMemoryBytes };
+}
+
+// Files that still exist in an open workspace folder and have testcases to judge
+function discoverProblems(judgeViewProvider: JudgeViewProvider): string[] {
+  return judgeViewProvider
+    .getFilesWithTestcases()
+    .filter(
+      (file) =>
+        fs.existsSync(file) &&
+        vscode.workspace.getWorkspaceFolder(vscode.Uri.file(file)) !== undefined
+    );
+}
+
+/**
+ * Compiles every problem in parallel (reusing the compile cache), then runs all of their
+ * testcases through one queue with a worker per core. Each worker is pinned to its own
+ * core, so problems don't slow each other down. Returns null when cancelled.
+ */
+async function judgeProblems(
+  files: string[],
+  judgeViewProvider: JudgeViewProvider,
+  context: vscode.ExtensionContext,
+  progress: vscode.Progress<{ message?: string; increment?: number }>,
+  token: vscode.CancellationToken
+): Promise<ProblemResult[] | null> {
+  progress.report({ message: `compiling ${files.length} problems` });
+  const prepared = await Promise.all(
+    files.map((file) => prepareVariant({ label: path.basename(file), file }, context))
+  );
+
+  const results: ProblemResult[] = [];
+  const jobs: BatchJob[] = [];
+  files.forEach((file, i) => {
+    const variant = prepared[i];
+    const testcases = getBenchmarkTestcases(judgeViewProvider, file);
+    const problem: ProblemResult = { file, testcases: testcases.length, verdicts: [] };
+    results.push(problem);
+    if (typeof variant === "string") {
+      problem.error = variant;
+      return;
+    }
+
+    const settings = getFileRunSettings(file);
+    const { timeLimit, memoryLimit } = judgeViewProvider.getLimitsForFile(file);
+    const limits = { timeLimit: getLocalTimeLimit(timeLimit), memoryLimit };
+    for (const testcase of testcases) {
+      jobs.push({
+        problem,
+        variant,
+        testcase,
+        limits,
+        inputFile: settings?.inputFile,
+        outputFile: settings?.outputFile,
+      });
+    }
+  });
+
+  let next = 0;
+  // One worker per CPU this process may use, each pinned to it
+  const cpus = getAllowedCpus();
+  const parallelism = Math.max(Math.min(cpus.length, jobs.length), 1);
+  const worker = async (slot: number) => {
+    while (next < jobs.length && !token.isCancellationRequested) {
+      await waitForWorkerSlot(slot, parallelism, token);
+      if (next >= jobs.length || token.isCancellationRequested) {
+        break;
+      }
+      const job = jobs[next++];
+      progress.report({
+        message: `${next} of ${jobs.length} testcases`,
+        increment: 100 / jobs.length,
+      });
+      job.problem.verdicts.push(await judgeTestcase(job, cpus[slot]));
+    }
+  };
+  await Promise.all(Array.from({ length: parallelism }, (_, slot) => worker(slot)));
+
+  return token.isCancellationRequested ? null : results;
+}
+
+function formatBatchReport(results: ProblemResult[]): string {
+  const multiplier = getTimeMultiplier();
+  const lines = [
+    "# Workspace Judge",
+    "",
+    multiplier !== 1
+      ? `Times are scaled to the calibrated judge (×${multiplier}).`
+      : "Times are local CPU times.",
+    "",
+    "| Problem | Verdict | Passed | Worst time | Worst memory |",
+    "|---|---|---:|---:|---:|",
+  ];
+  for (const problem of results) {
+    const name = vscode.workspace.asRelativePath(problem.file);
+    if (problem.error) {
+      const verdict = problem.error.endsWith("compilation failed") ? "CE" : "—";
+      lines.push(`| ${name} | ${verdict} | 0/${problem.testcases} | — | — |`);
+      continue;
+    }
+    if (problem.verdicts.length === 0) {
+      lines.push(`| ${name} | — | 0/0 | — | — |`);
+      continue;
+    }
+
+    const statuses = problem.verdicts.map((verdict) => verdict.status);
+    const verdict = VERDICT_ORDER.find((status) => statuses.includes(status)) ?? "NA";
+    const passed = statuses.filter((status) => status === "AC").length;
+    const worstElapsed = Math.max(...problem.verdicts.map((verdict) => verdict.elapsed));
+    const worstMemory = Math.max(...problem.verdicts.map((verdict) => verdict.memoryBytes));
+    lines.push(
+      `| ${name} | ${verdict} | ${passed}/${problem.testcases} | ${Math.round(worstElapsed * multiplier)}ms | ${formatBytes(worstMemory)} |`
+    );
+  }
+
+  const errors = results.filter((problem) => problem.error);
+  if (errors.length > 0) {
+    lines.push("", ...errors.map((problem) => `- ${problem.error}`));
+  }
+  lines.push("", "Interactive and skipped testcases are not run.");
+  return lines.join("\n");
+}
+
+async function judgeWorkspace(
+  judgeViewProvider: JudgeViewProvider,
+  context: vscode.ExtensionContext
+): Promise<void> {
+  const files = discoverProblems(judgeViewProvider);
+  if (files.length === 0) {
+    await vscode.window.showWarningMessage("No files with Judge testcases in the workspace");
+    return;
+  }
+
+  const results = await vscode.window.withProgress(
+    {
+      location: vscode.ProgressLocation.Notification,
+      title: "Judging workspace",
+      cancellable: true,
+    },
+    (progress, token) => judgeProblems(files, judgeViewProvider, context, progress, token)
+  );
+  if (!results) {
+    return;
+  }
+
+  const accepted = results.filter(
+    (problem) =>
+      !problem.error &&
+      problem.verdicts.length > 0 &&
+      problem.verdicts.every((verdict) => verdict.status === "AC")
+  ).length;
+  getLogger("judge").info(`Judged ${results.length} problems, ${accepted} fully accepted`);
+  await openInNewEditor(formatBatchReport(results), "Workspace Judge.md", files[0]);
+}
+
+export function registerBatchJudgeCommands(
+  context: vscode.ExtensionContext,
+  judgeViewProvider: JudgeViewProvider
+): void {
+  context.subscriptions.push(
+    vscode.commands.registerCommand("fastolympiccoding.judgeWorkspace", () =>
+      judgeWorkspace(judgeViewProvider, context)
+    )
+  );
+}
@@ -0,0 +1,700 @@
+import { readFileSync } from "node:fs";
+import * as fs from "node:fs/promises";
+import os from "node:os";
+import * as path from "node:path";
+import * as vscode from "vscode";
+
+import type JudgeViewProvider from "./providers/JudgeViewProvider";
+import {
+  compile,
+  compileVariant,
+  getMemoryPolicy,
+  getTimeLimitMode,
+  Runnable,
+  type RunTermination,
+} from "./utils/runtime";
+import { getFileRunSettings, openInNewEditor, TextHandler } from "./utils/vscode";
+import { getLogger } from "./utils/logging";
+import type { RuntimeProfile } from "../shared/schemas";
+
+export type BenchmarkVariant = {
+  label: string;
+  file: string;
+  flags?: string[]; // appended to the compile command when set
+};
+
+export type PreparedVariant = {
+  label: string;
+  runCommand: string[];
+  cwd?: string;
+  runtimeProfile?: RuntimeProfile;
+};
+
+export type BenchmarkSample = {
+  elapsed: number;
+  memoryBytes: number;
+  termination: RunTermination;
+  stdout: string;
+};
+
+export type BenchmarkTestcase = {
+  stdin: string;
+  acceptedStdout: string;
+};
+
+export type BenchmarkLimits = {
+  timeLimit: number;
+  memoryLimit: number;
+};
+
+// Two-sided 95% t critical values for 1..30 degrees of freedom
+const T_CRITICAL_95 = [
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.16,
+  2.145, 2.131, 2.12, 2.11, 2.101, 2.093, 2.086, 2.08, 2.074, 2.069, 2.064, 2.06, 2.056, 2.052,
+  2.048, 2.045, 2.042,
+];
+
+export type RatioInterval = {
+  estimate: number;
+  low: number;
+  high: number;
+};
+
+/**
+ * Geometric mean of the ratios with a 95% confidence interval computed on the log scale,
+ * so a 2x speedup and a 2x slowdown are treated symmetrically.
+ */
+export function ratioInterval(ratios: number[]): RatioInterval | null {
+  if (ratios.length === 0) {
+    return null;
+  }
+
+  const logs = ratios.map((ratio) => Math.log(ratio));
+  const mean = logs.reduce((sum, value) => sum + value, 0) / logs.length;
+  if (logs.length === 1) {
+    return { estimate: Math.exp(mean), low: Number.NaN, high: Number.NaN };
+  }
+
+  const variance = logs.reduce((sum, value) => sum + (value - mean) ** 2, 0) / (logs.length - 1);
+  const df = logs.length - 1;
+  const t = df <= T_CRITICAL_95.length ? T_CRITICAL_95[df - 1] : 1.96;
+  const margin = t * Math.sqrt(variance / logs.length);
+  return { estimate: Math.exp(mean), low: Math.exp(mean - margin), high: Math.exp(mean + margin) };
+}
+
+export function median(values: number[]): number {
+  if (values.length === 0) {
+    return Number.NaN;
+  }
+  const sorted = [...values].sort((a, b) => a - b);
+  const mid = Math.floor(sorted.length / 2);
+  return sorted.length % 2 === 0 ? (sorted[mid - 1] + sorted[mid]) / 2 : sorted[mid];
+}
+
+export function formatRatio(ratio: number): string {
+  return Number.isNaN(ratio) ? "-" : `${ratio.toFixed(2)}x`;
+}
+
+export function formatInterval(interval: RatioInterval | null): string {
+  if (!interval || Number.isNaN(interval.low)) {
+    return "-";
+  }
+  return `${formatRatio(interval.low)} – ${formatRatio(interval.high)}`;
+}
+
+// Managed runtimes are slower on their first runs while class data, bytecode caches, and
+// the page cache warm up, which judges running many submissions don't pay for
+function shouldWarmUp(variant: PreparedVariant): boolean {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return !!variant.runtimeProfile && config.get<boolean>("benchmarkRuntimeWarmup", true);
+}
+
+export function getBenchmarkRepetitions(): number {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return Math.max(config.get<number>("benchmarkRepetitions", 5), 2);
+}
+
+let allowedCpus: number[] | undefined;
+
+/**
+ * CPUs this process may run on, in order. On Linux a cpuset (containers, CI runners, taskset)
+ * can exclude some of the CPUs `os.cpus()` lists, and pinning a run to one of those fails.
+ */
+export function getAllowedCpus(): number[] {
+  if (allowedCpus) {
+    return allowedCpus;
+  }
+  allowedCpus = Array.from({ length: Math.max(os.cpus().length, 1) }, (_, cpu) => cpu);
+  if (process.platform === "linux") {
+    try {
+      const status = readFileSync("/proc/self/status", "utf8");
+      const list = status.match(/Cpus_allowed_list:\s+(\S+)/)?.[1] ?? "";
+      const cpus = list.split(",").flatMap((range) => {
+        const [first, last = first] = range.split("-").map(Number);
+        return Array.from({ length: last - first + 1 }, (_, i) => first + i);
+      });
+      if (cpus.length > 0 && cpus.every(Number.isInteger)) {
+        allowedCpus = cpus;
+      }
+    } catch {
+      // Keep every CPU
+    }
+  }
+  return allowedCpus;
+}
+
+// Pin to the last allowed CPU, which is the least likely to be shared with the editor's own
+// threads
+export function getBenchmarkCpu(): number {
+  return getAllowedCpus().at(-1)!;
+}
+
+/**
+ * Compiles the variant and resolves the command to run it. Returns an error message
+ * instead when the variant can't be built.
+ */
+export async function prepareVariant(
+  variant: BenchmarkVariant,
+  context: vscode.ExtensionContext
+): Promise<PreparedVariant | string> {
+  if (variant.flags) {
+    const build = compileVariant(variant.file, variant.flags, context);
+    if (!build) {
+      return `${variant.label}: compile flags need a compileCommand that writes to \${fileBasenameNoExtension}`;
+    }
+    const result = await build.result;
+    if (result.code !== 0) {
+      return `${variant.label}: compilation failed`;
+    }
+    return {
+      label: variant.label,
+      runCommand: build.languageSettings.runCommand!,
+      cwd: build.languageSettings.currentWorkingDirectory,
+      runtimeProfile: build.languageSettings.runtimeProfile,
+    };
+  }
+
+  const settings = getFileRunSettings(variant.file);
+  const compilePromise = compile(variant.file, context);
+  if (!settings || !compilePromise) {
+    return `${variant.label}: invalid run settings`;
+  }
+  if (!settings.languageSettings.runCommand) {
+    return `${variant.label}: no run command for ${path.basename(variant.file)}`;
+  }
+  const result = await compilePromise;
+  if (result.code !== 0) {
+    return `${variant.label}: compilation failed`;
+  }
+  return {
+    label: variant.label,
+    runCommand: settings.languageSettings.runCommand,
+    cwd: settings.languageSettings.currentWorkingDirectory,
+    runtimeProfile: settings.languageSettings.runtimeProfile,
+  };
+}
+
+export async function measure(
+  variant: PreparedVariant,
+  testcase: BenchmarkTestcase,
+  limits: BenchmarkLimits,
+  cpuAffinity: number
+): Promise<BenchmarkSample> {
+  const runnable = new Runnable();
+  const stdout = new TextHandler();
+  runnable
+    .on("spawn", () => runnable.stdin?.end(testcase.stdin))
+    .on("stdout:bytes", (data: Buffer) => stdout.write(data, "batch"))
+    .on("stdout:end", () => stdout.write("", "final"))
+    .run(variant.runCommand, limits.timeLimit, limits.memoryLimit, variant.cwd, {
+      cpuAffinity,
+      timeLimitMode: getTimeLimitMode(),
+      runtimeProfile: variant.runtimeProfile,
+      memoryPolicy: getMemoryPolicy(),
+    });
+  await runnable.done;
+  void runnable.dispose();
+
+  return {
+    elapsed: runnable.elapsed,
+    memoryBytes: runnable.maxMemoryBytes,
+    termination: runnable.termination,
+    stdout: stdout.data,
+  };
+}
+
+// Loads the runnable judge testcases of the file. Interactive and skipped testcases are
+// left out because their runtime depends on the interactor.
+export function getBenchmarkTestcases(
+  judgeViewProvider: JudgeViewProvider,
+  file: string
+): BenchmarkTestcase[] {
+  return judgeViewProvider
+    .exportTestcasesForFile(file)
+    .filter((testcase) => testcase.mode === "standard" && !testcase.skipped)
+    .map((testcase) => ({ stdin: testcase.stdin, acceptedStdout: testcase.acceptedStdout }));
+}
+
+// samples[variant][testcase] holds one sample per round
+type SampleMatrix = BenchmarkSample[][][];
+
+type BenchmarkProgress = vscode.Progress<{ message?: string; increment?: number }>;
+
+async function prepareAll(
+  variants: BenchmarkVariant[],
+  context: vscode.ExtensionContext
+): Promise<PreparedVariant[] | null> {
+  const prepared = await Promise.all(variants.map((variant) => prepareVariant(variant, context)));
+  const errors = prepared.filter((result): result is string => typeof result === "string");
+  if (errors.length > 0) {
+    void vscode.window.showErrorMessage(errors.join("; "));
+    return null;
+  }
+  return prepared as PreparedVariant[];
+}
+
+/**
+ * Runs every variant over the testcases for the given number of rounds. The variant
+ * order rotates every round so drift (thermal throttling, background load) affects all
+ * variants evenly. Returns null when cancelled.
+ */
+async function runInterleaved(
+  variants: PreparedVariant[],
+  testcases: BenchmarkTestcase[],
+  limits: BenchmarkLimits,
+  repetitions: number,
+  cpu: number,
+  progress: BenchmarkProgress,
+  token: vscode.CancellationToken
+): Promise<SampleMatrix | null> {
+  const samples: SampleMatrix = variants.map(() => testcases.map(() => []));
+  const increment = 100 / (repetitions * testcases.length);
+  const warmUp = variants.filter(shouldWarmUp);
+  if (warmUp.length > 0) {
+    progress.report({ message: "Warming up runtimes" });
+  }
+  for (const variant of warmUp) {
+    for (const testcase of testcases) {
+      if (token.isCancellationRequested) {
+        return null;
+      }
+      await measure(variant, testcase, limits, cpu);
+    }
+  }
+  for (let round = 0; round < repetitions; round++) {
+    for (let i = 0; i < testcases.length; i++) {
+      progress.report({
+        message: `Round ${round + 1}/${repetitions}, testcase #${i + 1}`,
+        increment,
+      });
+      for (let offset = 0; offset < variants.length; offset++) {
+        if (token.isCancellationRequested) {
+          return null;
+        }
+        const v = (round + offset) % variants.length;
+        samples[v][i].push(await measure(variants[v], testcases[i], limits, cpu));
+      }
+    }
+  }
+  return samples;
+}
+
+// Clamp so sub-millisecond runs don't divide by zero
+function speedup(a: BenchmarkSample, b: BenchmarkSample): number {
+  return Math.max(a.elapsed, 1) / Math.max(b.elapsed, 1);
+}
+
+function describeFailures(samples: BenchmarkSample[], label: string): string[] {
+  const terminations = new Set(
+    samples.filter((sample) => sample.termination !== "exit").map((sample) => sample.termination)
+  );
+  return [...terminations].map((termination) => `${label}: ${termination}`);
+}
+
+function formatComparisonReport(
+  a: PreparedVariant,
+  b: PreparedVariant,
+  samples: SampleMatrix,
+  repetitions: number,
+  cpu: number
+): string {
+  const [samplesA, samplesB] = samples;
+  const lines = [
+    `# ${a.label} vs ${b.label}`,
+    "",
+    `${repetitions} interleaved runs per testcase, pinned to CPU ${cpu}. Speedup above 1 means **${b.label}** is faster.`,
+    "",
+    `| Testcase | ${a.label} median | ${b.label} median | Speedup | 95% CI | Notes |`,
+    "| --- | --- | --- | --- | --- | --- |",
+  ];
+
+  const totalRatios: number[] = [];
+  for (let round = 0; round < repetitions; round++) {
+    let totalA = 0;
+    let totalB = 0;
+    let valid = true;
+    for (let i = 0; i < samplesA.length; i++) {
+      const sampleA = samplesA[i][round];
+      const sampleB = samplesB[i][round];
+      if (sampleA.termination !== "exit" || sampleB.termination !== "exit") {
+        valid = false;
+        break;
+      }
+      totalA += sampleA.elapsed;
+      totalB += sampleB.elapsed;
+    }
+    if (valid && samplesA.length > 0) {
+      totalRatios.push(Math.max(totalA, 1) / Math.max(totalB, 1));
+    }
+  }
+
+  let differences = 0;
+  for (let i = 0; i < samplesA.length; i++) {
+    const ratios: number[] = [];
+    for (let round = 0; round < repetitions; round++) {
+      const sampleA = samplesA[i][round];
+      const sampleB = samplesB[i][round];
+      if (sampleA.termination === "exit" && sampleB.termination === "exit") {
+        ratios.push(speedup(sampleA, sampleB));
+      }
+    }
+
+    const notes = [
+      ...describeFailures(samplesA[i], a.label),
+      ...describeFailures(samplesB[i], b.label),
+    ];
+    const outputsA = new Set(samplesA[i].map((sample) => sample.stdout));
+    const outputsB = new Set(samplesB[i].map((sample) => sample.stdout));
+    if (outputsA.size > 1 || outputsB.size > 1) {
+      notes.push("output varies between runs");
+    }
+    if (samplesA[i][0].stdout !== samplesB[i][0].stdout) {
+      notes.push("**outputs differ**");
+      differences++;
+    }
+
+    const interval = ratioInterval(ratios);
+    const medianA = median(samplesA[i].map((sample) => sample.elapsed));
+    const medianB = median(samplesB[i].map((sample) => sample.elapsed));
+    const estimate = formatRatio(interval?.estimate ?? Number.NaN);
+    lines.push(
+      `| #${i + 1} | ${medianA}ms | ${medianB}ms | ${estimate} | ${formatInterval(interval)} | ${notes.join(", ")} |`
+    );
+  }
+
+  const total = ratioInterval(totalRatios);
+  lines.push(
+    "",
+    `**Total speedup:** ${formatRatio(total?.estimate ?? Number.NaN)} (95% CI ${formatInterval(total)})`
+  );
+  if (differences > 0) {
+    lines.push("", `⚠️ Outputs differ on ${differences} testcase(s).`);
+  }
+  return lines.join("\n") + "\n";
+}
+
+async function compareVariants(
+  variantA: BenchmarkVariant,
+  variantB: BenchmarkVariant,
+  testcases: BenchmarkTestcase[],
+  limits: BenchmarkLimits,
+  context: vscode.ExtensionContext
+): Promise<string | null> {
+  const repetitions = getBenchmarkRepetitions();
+  const cpu = getBenchmarkCpu();
+
+  return vscode.window.withProgress(
+    {
+      location: vscode.ProgressLocation.Notification,
+      title: `Comparing ${variantA.label} and ${variantB.label}`,
+      cancellable: true,
+    },
+    async (progress, token) => {
+      progress.report({ message: "Compiling..." });
+      const prepared = await prepareAll([variantA, variantB], context);
+      if (!prepared || token.isCancellationRequested) {
+        return null;
+      }
+
+      const samples = await runInterleaved(
+        prepared,
+        testcases,
+        limits,
+        repetitions,
+        cpu,
+        progress,
+        token
+      );
+      if (!samples) {
+        return null;
+      }
+      return formatComparisonReport(prepared[0], prepared[1], samples, repetitions, cpu);
+    }
+  );
+}
+
+// The run command of a compiled language starts with the built binary
+async function getBinarySize(variant: PreparedVariant): Promise<number | null> {
+  for (const candidate of [variant.runCommand[0], `${variant.runCommand[0]}.exe`]) {
+    try {
+      const stat = await fs.stat(candidate);
+      if (stat.isFile()) {
+        return stat.size;
+      }
+    } catch {
+      // Not a file path (e.g. an interpreter on PATH)
+    }
+  }
+  return null;
+}
+
+export function formatBytes(bytes: number): string {
+  if (bytes >= 1024 * 1024 * 1024) {
+    return (bytes / (1024 * 1024 * 1024)).toFixed(1) + "GB";
+  }
+  if (bytes >= 1024 * 1024) {
+    return (bytes / (1024 * 1024)).toFixed(1) + "MB";
+  }
+  if (bytes >= 1024) {
+    return (bytes / 1024).toFixed(0) + "KB";
+  }
+  return bytes + "B";
+}
+
+function formatMatrixReport(
+  file: string,
+  variants: PreparedVariant[],
+  testcases: BenchmarkTestcase[],
+  samples: SampleMatrix,
+  binarySizes: (number | null)[],
+  repetitions: number,
+  cpu: number
+): string {
+  const lines = [
+    `# Compile flags for ${path.basename(file)}`,
+    "",
+    `${repetitions} interleaved runs per testcase, pinned to CPU ${cpu}. Time is the sum of per-testcase medians, relative to the first flag set.`,
+    "",
+    "| Flags | Time | Relative | Peak memory | Binary size | Result |",
+    "| --- | --- | --- | --- | --- | --- |",
+  ];
+
+  // Without an accepted answer, the first flag set's output is the reference
+  const reference = testcases.map((testcase, i) =>
+    testcase.acceptedStdout.trim() !== "" ? testcase.acceptedStdout : samples[0][i][0].stdout
+  );
+  const totals = samples.map((perTestcase) =>
+    perTestcase.reduce((sum, runs) => sum + median(runs.map((sample) => sample.elapsed)), 0)
+  );
+
+  let fastestSafe = -1;
+  variants.forEach((variant, v) => {
+    const problems = new Set<string>();
+    samples[v].forEach((runs, i) => {
+      for (const sample of runs) {
+        if (sample.termination !== "exit") {
+          problems.add(sample.termination);
+        } else if (sample.stdout !== reference[i]) {
+          problems.add("wrong output");
+        }
+      }
+    });
+    if (problems.size === 0 && (fastestSafe === -1 || totals[v] < totals[fastestSafe])) {
+      fastestSafe = v;
+    }
+
+    const peakMemory = Math.max(
+      ...samples[v].flatMap((runs) => runs.map((sample) => sample.memoryBytes))
+    );
+    const relative = formatRatio(Math.max(totals[v], 1) / Math.max(totals[0], 1));
+    const binarySize = binarySizes[v];
+    const size = binarySize === null ? "-" : formatBytes(binarySize);
+    const result = problems.size === 0 ? "✓" : [...problems].join(", ");
+    lines.push(
+      `| \`${variant.label}\` | ${totals[v]}ms | ${relative} | ${formatBytes(peakMemory)} | ${size} | ${result} |`
+    );
+  });
+
+  lines.push(
+    "",
+    fastestSafe === -1
+      ? "⚠️ No flag set produced correct output on every testcase."
+      : `**Fastest safe flags:** \`${variants[fastestSafe].label}\``
+  );
+  return lines.join("\n") + "\n";
+}
+
+/**
+ * Compiles the file under every flag set in parallel, each into its own binary, then
+ * benchmarks the builds over the testcases.
+ */
+async function benchmarkFlagMatrix(
+  file: string,
+  flagSets: string[],
+  testcases: BenchmarkTestcase[],
+  limits: BenchmarkLimits,
+  context: vscode.ExtensionContext
+): Promise<string | null> {
+  const repetitions = getBenchmarkRepetitions();
+  const cpu = getBenchmarkCpu();
+
+  return vscode.window.withProgress(
+    {
+      location: vscode.ProgressLocation.Notification,
+      title: `Benchmarking ${flagSets.length} flag sets`,
+      cancellable: true,
+    },
+    async (progress, token) => {
+      progress.report({ message: "Compiling..." });
+      const prepared = await prepareAll(
+        flagSets.map((flags) => ({
+          label: flags || "(no extra flags)",
+          file,
+          flags: parseFlags(flags),
+        })),
+        context
+      );
+      if (!prepared || token.isCancellationRequested) {
+        return null;
+      }
+
+      const binarySizes = await Promise.all(prepared.map((variant) => getBinarySize(variant)));
+      const samples = await runInterleaved(
+        prepared,
+        testcases,
+        limits,
+        repetitions,
+        cpu,
+        progress,
+        token
+      );
+      if (!samples) {
+        return null;
+      }
+      return formatMatrixReport(file, prepared, testcases, samples, binarySizes, repetitions, cpu);
+    }
+  );
+}
+
+function parseFlags(value: string): string[] {
+  return value.split(/\s+/).filter((flag) => flag.length > 0);
+}
+
+async function pickComparisonVariants(
+  file: string
+): Promise<[BenchmarkVariant, BenchmarkVariant] | undefined> {
+  const mode = await vscode.window.showQuickPick(
+    [
+      { label: "Another solution file", value: "file" as const },
+      { label: "Different compile flags", value: "flags" as const },
+    ],
+    { title: "Compare Solution Performance" }
+  );
+  if (!mode) {
+    return undefined;
+  }
+
+  if (mode.value === "file") {
+    const selected = await vscode.window.showOpenDialog({
+      canSelectFiles: true,
+      canSelectFolders: false,
+      canSelectMany: false,
+      defaultUri: vscode.Uri.file(path.dirname(file)),
+      openLabel: "Compare",
+    });
+    const other = selected?.[0]?.fsPath;
+    if (!other) {
+      return undefined;
+    }
+    return [
+      { label: path.basename(file), file },
+      { label: path.basename(other), file: other },
+    ];
+  }
+
+  const flagsA = await vscode.window.showInputBox({
+    title: "Compile flags for A (appended to compileCommand)",
+    placeHolder: "-O2",
+  });
+  if (flagsA === undefined) {
+    return undefined;
+  }
+  const flagsB = await vscode.window.showInputBox({
+    title: "Compile flags for B (appended to compileCommand)",
+    placeHolder: "-O3 -march=native",
+  });
+  if (flagsB === undefined) {
+    return undefined;
+  }
+  return [
+    { label: flagsA.trim() || "A", file, flags: parseFlags(flagsA) },
+    { label: flagsB.trim() || "B", file, flags: parseFlags(flagsB) },
+  ];
+}
+
+export function registerBenchmarkCommands(
+  context: vscode.ExtensionContext,
+  judgeViewProvider: JudgeViewProvider
+): void {
+  context.subscriptions.push(
+    vscode.commands.registerCommand("fastolympiccoding.compareSolutions", async () => {
+      const file = judgeViewProvider.getCurrentFile();
+      if (!file) {
+        await vscode.window.showWarningMessage("Open a file in Judge before comparing solutions");
+        return;
+      }
+
+      const testcases = getBenchmarkTestcases(judgeViewProvider, file);
+      if (testcases.length === 0) {
+        await vscode.window.showWarningMessage("No runnable testcases to compare with");
+        return;
+      }
+
+      const variants = await pickComparisonVariants(file);
+      if (!variants) {
+        return;
+      }
+
+      const limits = judgeViewProvider.getLimitsForFile(file);
+      const report = await compareVariants(...variants, testcases, limits, context);
+      if (report) {
+        getLogger("benchmark").info(`Compared ${variants[0].label} and ${variants[1].label}`);
+        await openInNewEditor(report, "Solution Comparison.md", file);
+      }
+    })
+  );
+
+  context.subscriptions.push(
+    vscode.commands.registerCommand("fastolympiccoding.benchmarkCompileFlags", async () => {
+      const file = judgeViewProvider.getCurrentFile();
+      if (!file) {
+        await vscode.window.showWarningMessage("Open a file in Judge before benchmarking flags");
+        return;
+      }
+
+      const testcases = getBenchmarkTestcases(judgeViewProvider, file);
+      if (testcases.length === 0) {
+        await vscode.window.showWarningMessage("No runnable testcases to benchmark with");
+        return;
+      }
+
+      const config = vscode.workspace.getConfiguration("fastolympiccoding");
+      const matrix = config.get<string[]>("compileFlagMatrix", []);
+      const picked = await vscode.window.showQuickPick(
+        matrix.map((flags) => ({ label: flags || "(no extra flags)", flags, picked: true })),
+        { title: "Benchmark Compile Flags", canPickMany: true }
+      );
+      if (!picked || picked.length === 0) {
+        return;
+      }
+
+      const limits = judgeViewProvider.getLimitsForFile(file);
+      const flagSets = picked.map((item) => item.flags);
+      const report = await benchmarkFlagMatrix(file, flagSets, testcases, limits, context);
+      if (report) {
+        getLogger("benchmark").info(`Benchmarked ${flagSets.length} flag sets for ${file}`);
+        await openInNewEditor(report, "Compile Flags.md", file);
+      }
+    })
+  );
+}
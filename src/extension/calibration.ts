@@ -0,0 +1,209 @@
+import * as path from "node:path";
+import * as vscode from "vscode";
+
+import { getBenchmarkCpu } from "./benchmark";
+import { compileWithCommand, Runnable } from "./utils/runtime";
+import { openInNewEditor, TextHandler } from "./utils/vscode";
+import { getLogger } from "./utils/logging";
+
+const KERNELS = ["cpu", "memory", "cache"] as const;
+const CALIBRATION_RUNS = 3;
+
+type Kernel = (typeof KERNELS)[number];
+export type CalibrationScores = Record<Kernel, number>; // CPU milliseconds per kernel
+
+type CalibrationRun = {
+  scores: CalibrationScores;
+  elapsed: number; // as measured by the process monitor
+};
+
+function parseScores(stdout: string): CalibrationScores | null {
+  const scores: Partial<CalibrationScores> = {};
+  for (const line of stdout.split("\n")) {
+    const [name, value] = line.trim().split(/\s+/);
+    if ((KERNELS as readonly string[]).includes(name) && Number(value) > 0) {
+      scores[name as Kernel] = Number(value);
+    }
+  }
+  return KERNELS.every((kernel) => scores[kernel] !== undefined)
+    ? (scores as CalibrationScores)
+    : null;
+}
+
+/**
+ * Time multiplier from local to judge timings: the geometric mean of the per-kernel ratios,
+ * so no single kernel dominates. Returns null if the reference is missing a kernel.
+ */
+export function computeTimeMultiplier(
+  local: CalibrationScores,
+  reference: Partial<CalibrationScores>
+): number | null {
+  let logSum = 0;
+  for (const kernel of KERNELS) {
+    const value = reference[kernel];
+    if (typeof value !== "number" || value <= 0) {
+      return null;
+    }
+    logSum += Math.log(value / local[kernel]);
+  }
+  return Math.exp(logSum / KERNELS.length);
+}
+
+function getReferenceScores(): Record<string, Partial<CalibrationScores>> {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return config.get<Record<string, Partial<CalibrationScores>>>("judgeReferenceScores", {});
+}
+
+async function runCalibration(
+  binary: string,
+  progress: vscode.Progress<{ message?: string; increment?: number }>,
+  token: vscode.CancellationToken
+): Promise<CalibrationRun | null> {
+  // Keep the fastest run of each kernel, since interference only ever adds time
+  let best: CalibrationRun | null = null;
+  for (let run = 0; run < CALIBRATION_RUNS && !token.isCancellationRequested; run++) {
+    progress.report({
+      message: `run ${run + 1} of ${CALIBRATION_RUNS}`,
+      increment: 100 / CALIBRATION_RUNS,
+    });
+
+    const runnable = new Runnable();
+    const stdout = new TextHandler();
+    const cancellation = token.onCancellationRequested(() => runnable.stop());
+    runnable
+      .on("stdout:bytes", (data: Buffer) => stdout.write(data, "batch"))
+      .on("stdout:end", () => stdout.write("", "final"))
+      .run([binary], 0, 0, path.dirname(binary), { cpuAffinity: getBenchmarkCpu() });
+    await runnable.done;
+    cancellation.dispose();
+    void runnable.dispose();
+
+    const scores = parseScores(stdout.data);
+    if (runnable.termination !== "exit" || !scores) {
+      getLogger("benchmark").error(
+        `Calibration run failed (termination=${runnable.termination}, stdout=${stdout.data})`
+      );
+      return null;
+    }
+    if (!best) {
+      best = { scores, elapsed: runnable.elapsed };
+    } else {
+      for (const kernel of KERNELS) {
+        best.scores[kernel] = Math.min(best.scores[kernel], scores[kernel]);
+      }
+      best.elapsed = Math.min(best.elapsed, runnable.elapsed);
+    }
+  }
+  return token.isCancellationRequested ? null : best;
+}
+
+function formatCalibrationReport(
+  local: CalibrationRun,
+  references: Record<string, Partial<CalibrationScores>>
+): string {
+  const judges = Object.keys(references);
+  const header = ["Kernel", "Local", ...judges];
+  const lines = [
+    "# Machine Speed Calibration",
+    "",
+    `Fastest of ${CALIBRATION_RUNS} runs, pinned to CPU ${getBenchmarkCpu()}. ` +
+      "Times are CPU milliseconds.",
+    "",
+    `| ${header.join(" | ")} |`,
+    `|${header.map((_, i) => (i === 0 ? "---" : "---:")).join("|")}|`,
+  ];
+  for (const kernel of KERNELS) {
+    const cells = judges.map((judge) => {
+      const value = references[judge][kernel];
+      return typeof value === "number" ? `${value}` : "—";
+    });
+    lines.push(`| ${[kernel, local.scores[kernel], ...cells].join(" | ")} |`);
+  }
+
+  lines.push("");
+  if (judges.length === 0) {
+    lines.push(
+      "No reference scores configured. Submit `calibrate.cpp` to a judge's custom invocation " +
+        "with g++ -O2 and add its output to `fastolympiccoding.judgeReferenceScores` as " +
+        '`"<judge>": { "cpu": <ms>, "memory": <ms>, "cache": <ms> }`.'
+    );
+  } else {
+    lines.push("| Judge | Time multiplier |", "|---|---:|");
+    for (const judge of judges) {
+      const multiplier = computeTimeMultiplier(local.scores, references[judge]);
+      const cell = multiplier === null ? "incomplete scores" : `×${multiplier.toFixed(2)}`;
+      lines.push(`| ${judge} | ${cell} |`);
+    }
+  }
+  lines.push("", `Total benchmark time reported by the process monitor: ${local.elapsed}ms`);
+  return lines.join("\n");
+}
+
+async function calibrateMachineSpeed(context: vscode.ExtensionContext): Promise<void> {
+  const logger = getLogger("benchmark");
+  const source = context.asAbsolutePath(path.join("media", "calibration", "calibrate.cpp"));
+  const outputDir = vscode.Uri.joinPath(context.globalStorageUri, "calibration");
+  await vscode.workspace.fs.createDirectory(outputDir);
+  const binary = path.join(
+    outputDir.fsPath,
+    process.platform === "win32" ? "calibrate.exe" : "calibrate"
+  );
+
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  const compiler = config.get<string>("calibrationCompiler", "g++");
+  const result = await compileWithCommand(
+    source,
+    [compiler, "-O2", "-std=c++17", source, "-o", binary],
+    context
+  );
+  if (result.code !== 0) {
+    logger.error(`Failed to compile the calibration benchmark: ${result.stderr}`);
+    await vscode.window.showErrorMessage(
+      `Failed to compile the calibration benchmark with ${compiler}`
+    );
+    return;
+  }
+
+  const local = await vscode.window.withProgress(
+    {
+      location: vscode.ProgressLocation.Notification,
+      title: "Calibrating machine speed",
+      cancellable: true,
+    },
+    (progress, token) => runCalibration(binary, progress, token)
+  );
+  if (!local) {
+    return;
+  }
+  logger.info(`Calibration scores: ${JSON.stringify(local.scores)}`);
+
+  const references = getReferenceScores();
+  await openInNewEditor(formatCalibrationReport(local, references), "Calibration.md", source);
+
+  const choices = Object.entries(references).flatMap(([judge, reference]) => {
+    const multiplier = computeTimeMultiplier(local.scores, reference);
+    return multiplier === null
+      ? []
+      : [{ label: judge, description: `×${multiplier.toFixed(2)}`, multiplier }];
+  });
+  if (choices.length === 0) {
+    return;
+  }
+  const picked = await vscode.window.showQuickPick(
+    [...choices, { label: "Local", description: "×1.00 (no scaling)", multiplier: 1 }],
+    { title: "Scale judge times to", placeHolder: "Pick the judge to emulate" }
+  );
+  if (picked) {
+    const multiplier = Math.round(picked.multiplier * 100) / 100;
+    await config.update("timeMultiplier", multiplier, vscode.ConfigurationTarget.Global);
+    logger.info(`Time multiplier set to ${multiplier} (${picked.label})`);
+  }
+}
+
+export function registerCalibrationCommands(context: vscode.ExtensionContext): void {
+  context.subscriptions.push(
+    vscode.commands.registerCommand("fastolympiccoding.calibrateMachineSpeed", () =>
+      calibrateMachineSpeed(context)
+    )
+  );
+}
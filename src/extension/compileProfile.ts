@@ -0,0 +1,303 @@
+import * as fs from "node:fs/promises";
+import os from "node:os";
+import * as path from "node:path";
+import * as vscode from "vscode";
+
+import { Runnable } from "./utils/runtime";
+import { getFileRunSettings, openInNewEditor } from "./utils/vscode";
+import { getLogger } from "./utils/logging";
+
+export type Compiler = "clang" | "gcc";
+
+type Phase = {
+  name: string;
+  ms: number;
+};
+
+type Hotspot = {
+  name: string;
+  ms: number;
+  count: number;
+};
+
+type CompileProfile = {
+  compiler: Compiler;
+  wallMs: number; // whole compiler driver run, including linking
+  phases: Phase[];
+  headers: Hotspot[];
+  templates: Hotspot[];
+  timers: Hotspot[]; // GCC only, in place of headers and templates
+};
+
+type TraceEvent = {
+  name?: string;
+  ph?: string;
+  dur?: number; // microseconds
+  args?: { detail?: string };
+};
+
+const TOP_HOTSPOTS = 10;
+
+// Totals clang emits per event kind, in the order they happen during a compile
+const CLANG_PHASES: [string, string][] = [
+  ["Total Source", "Parsing headers and source"],
+  ["Total ParseClass", "Parsing classes"],
+  ["Total InstantiateClass", "Template instantiation (classes)"],
+  ["Total InstantiateFunction", "Template instantiation (functions)"],
+  ["Total Frontend", "Frontend"],
+  ["Total OptModule", "Optimization"],
+  ["Total CodeGenPasses", "Code generation"],
+  ["Total Backend", "Backend"],
+];
+
+// GCC phases in -ftime-report, which partition the compiler proper's time
+const GCC_PHASES: [string, string][] = [
+  ["phase setup", "Setup"],
+  ["phase parsing", "Parsing headers and source"],
+  ["phase lang. deferred", "Deferred parsing and instantiation"],
+  ["phase opt and generate", "Optimization and code generation"],
+  ["phase last asm", "Assembly output"],
+  ["phase finalize", "Finalize"],
+];
+
+export async function runCommand(command: string[], cwd?: string) {
+  const runnable = new Runnable();
+  let stdout = "";
+  let stderr = "";
+  runnable
+    .on("stdout:data", (data: string) => (stdout += data))
+    .on("stderr:data", (data: string) => (stderr += data))
+    .run(command, 0, 0, cwd);
+  await runnable.done;
+  void runnable.dispose();
+  return { exitCode: runnable.exitCode, wallMs: runnable.wallTime, stdout, stderr };
+}
+
+// g++ and c++ are clang on macOS, so ask the compiler instead of trusting its name
+export async function detectCompiler(compiler: string): Promise<Compiler | null> {
+  const { stdout, stderr } = await runCommand([compiler, "--version"]);
+  const version = stdout + stderr;
+  if (/clang/i.test(version)) {
+    return "clang";
+  }
+  if (/gcc|g\+\+|Free Software Foundation/i.test(version)) {
+    return "gcc";
+  }
+  return null;
+}
+
+function addHotspot(hotspots: Map<string, Hotspot>, name: string, ms: number) {
+  const hotspot = hotspots.get(name) ?? { name, ms: 0, count: 0 };
+  hotspot.ms += ms;
+  hotspot.count++;
+  hotspots.set(name, hotspot);
+}
+
+function topHotspots(hotspots: Map<string, Hotspot>): Hotspot[] {
+  return [...hotspots.values()].sort((a, b) => b.ms - a.ms).slice(0, TOP_HOTSPOTS);
+}
+
+/**
+ * Reads a clang -ftime-trace file. Header and template times are inclusive, so a header
+ * also counts the time spent in the headers it includes.
+ */
+function parseClangTrace(trace: string, wallMs: number): Omit<CompileProfile, "compiler"> {
+  const events = (JSON.parse(trace) as { traceEvents?: TraceEvent[] }).traceEvents ?? [];
+  const totals = new Map<string, number>();
+  const headers = new Map<string, Hotspot>();
+  const templates = new Map<string, Hotspot>();
+  for (const event of events) {
+    if (event.ph !== "X" || !event.name || event.dur === undefined) {
+      continue;
+    }
+    const ms = event.dur / 1000;
+    if (event.name.startsWith("Total ")) {
+      totals.set(event.name, ms);
+    } else if (event.name === "Source" && event.args?.detail) {
+      addHotspot(headers, event.args.detail, ms);
+    } else if (
+      (event.name === "InstantiateClass" || event.name === "InstantiateFunction") &&
+      event.args?.detail
+    ) {
+      addHotspot(templates, event.args.detail, ms);
+    }
+  }
+
+  const phases = CLANG_PHASES.filter(([key]) => totals.has(key)).map(([key, name]) => ({
+    name,
+    ms: totals.get(key)!,
+  }));
+  const compilerMs = totals.get("Total ExecuteCompiler");
+  if (compilerMs !== undefined) {
+    phases.push({ name: "Linking and driver", ms: Math.max(wallMs - compilerMs, 0) });
+  }
+  return {
+    wallMs,
+    phases,
+    headers: topHotspots(headers),
+    templates: topHotspots(templates),
+    timers: [],
+  };
+}
+
+/**
+ * Reads the -ftime-report table GCC writes to stderr. GCC has no per-header breakdown, so
+ * the largest non-phase timers stand in for the hotspots.
+ */
+function parseGccTimeReport(stderr: string, wallMs: number): Omit<CompileProfile, "compiler"> {
+  // " phase parsing   :   2.38 ( 85%)   1.10 ( 90%)   3.70 ( 87%)   167M ( 87%)" and
+  // " TOTAL           :   2.81          1.22          4.27          193M" (usr, sys, wall)
+  const row = /^\s*\|?([^:]+?)\s*:\s*[\d.]+\s*(?:\(\s*\d+%\))?\s+[\d.]+\s*(?:\(\s*\d+%\))?\s+([\d.]+)/;
+  const timers = new Map<string, number>();
+  for (const line of stderr.split("\n")) {
+    const match = row.exec(line);
+    if (match) {
+      // Multiple translation units report separately, so sum them
+      timers.set(match[1], (timers.get(match[1]) ?? 0) + Number(match[2]) * 1000);
+    }
+  }
+
+  const phases = GCC_PHASES.filter(([key]) => timers.has(key)).map(([key, name]) => ({
+    name,
+    ms: timers.get(key)!,
+  }));
+  const compilerMs = timers.get("TOTAL");
+  if (compilerMs !== undefined) {
+    phases.push({ name: "Linking and driver", ms: Math.max(wallMs - compilerMs, 0) });
+  }
+  const hotspots = new Map<string, Hotspot>();
+  for (const [name, ms] of timers) {
+    if (!name.startsWith("phase ") && name !== "TOTAL" && ms > 0) {
+      hotspots.set(name, { name, ms, count: 1 });
+    }
+  }
+  return { wallMs, phases, headers: [], templates: [], timers: topHotspots(hotspots) };
+}
+
+function formatMs(ms: number): string {
+  return ms >= 1000 ? `${(ms / 1000).toFixed(2)}s` : `${Math.round(ms)}ms`;
+}
+
+function formatHotspots(title: string, hotspots: Hotspot[], withCount: boolean): string[] {
+  if (hotspots.length === 0) {
+    return [];
+  }
+  return [
+    "",
+    `## ${title}`,
+    "",
+    withCount ? "| Name | Time | Count |" : "| Timer | Time |",
+    withCount ? "|---|---:|---:|" : "|---|---:|",
+    ...hotspots.map((hotspot) => {
+      const name = hotspot.name.replaceAll("|", "\\|");
+      return withCount
+        ? `| \`${name}\` | ${formatMs(hotspot.ms)} | ${hotspot.count} |`
+        : `| ${name} | ${formatMs(hotspot.ms)} |`;
+    }),
+  ];
+}
+
+function formatProfileReport(file: string, profile: CompileProfile): string {
+  const lines = [
+    "# Compilation Profile",
+    "",
+    `${path.basename(file)}, ${profile.compiler === "clang" ? "clang -ftime-trace" : "gcc -ftime-report"}, ${formatMs(profile.wallMs)} total`,
+    "",
+    "| Phase | Time | Share |",
+    "|---|---:|---:|",
+    ...profile.phases.map(
+      (phase) =>
+        `| ${phase.name} | ${formatMs(phase.ms)} | ${profile.wallMs > 0 ? Math.round((phase.ms / profile.wallMs) * 100) : 0}% |`
+    ),
+  ];
+  if (profile.compiler === "clang") {
+    lines.push(
+      ...formatHotspots("Slowest headers", profile.headers, true),
+      ...formatHotspots("Slowest template instantiations", profile.templates, true),
+      "",
+      "Phases nest, so they can add up to more than the total. Header and template times " +
+        "include everything they pull in."
+    );
+  } else {
+    lines.push(
+      ...formatHotspots("Slowest compiler timers", profile.timers, false),
+      "",
+      "GCC does not break parsing down by header. Profile with clang to find the headers " +
+        "worth precompiling."
+    );
+  }
+  return lines.join("\n");
+}
+
+async function profileCompilation(file: string): Promise<void> {
+  const logger = getLogger("compilation");
+  // Build into a separate binary when the compile command allows it, so a testcase that is
+  // still running doesn't hold the real one open
+  const settings =
+    getFileRunSettings(file, { fileBasenameNoExtension: `${path.parse(file).name}.profile` }) ??
+    getFileRunSettings(file);
+  const compileCommand = settings?.languageSettings.compileCommand;
+  if (!compileCommand) {
+    await vscode.window.showWarningMessage(`No compile command for ${path.basename(file)}`);
+    return;
+  }
+
+  const traceDirectory = await fs.mkdtemp(path.join(os.tmpdir(), "foc-compile-profile-"));
+  try {
+    const compiler = await detectCompiler(compileCommand[0]);
+    if (!compiler) {
+      await vscode.window.showErrorMessage(
+        `Compilation profiling supports GCC and Clang, not ${compileCommand[0]}`
+      );
+      return;
+    }
+
+    const flags =
+      compiler === "clang" ? [`-ftime-trace=${traceDirectory}${path.sep}`] : ["-ftime-report"];
+    const result = await vscode.window.withProgress(
+      {
+        location: vscode.ProgressLocation.Notification,
+        title: `Profiling compilation of ${path.basename(file)}`,
+      },
+      () =>
+        runCommand(
+          [...compileCommand, ...flags],
+          settings.languageSettings.currentWorkingDirectory
+        )
+    );
+    if (result.exitCode !== 0) {
+      logger.error(`Profiled compilation failed (file=${file}): ${result.stderr}`);
+      await vscode.window.showErrorMessage(`Failed to compile ${path.basename(file)}`);
+      return;
+    }
+
+    let profile: Omit<CompileProfile, "compiler">;
+    if (compiler === "clang") {
+      const traces = (await fs.readdir(traceDirectory)).filter((name) => name.endsWith(".json"));
+      if (traces.length === 0) {
+        await vscode.window.showErrorMessage(`${compileCommand[0]} did not write a time trace`);
+        return;
+      }
+      const trace = await fs.readFile(path.join(traceDirectory, traces[0]), "utf8");
+      profile = parseClangTrace(trace, result.wallMs);
+    } else {
+      profile = parseGccTimeReport(result.stderr, result.wallMs);
+    }
+    logger.info(`Profiled compilation of ${file} in ${result.wallMs}ms`);
+    await openInNewEditor(
+      formatProfileReport(file, { compiler, ...profile }),
+      "Compilation Profile.md",
+      file
+    );
+  } finally {
+    await fs.rm(traceDirectory, { recursive: true, force: true });
+  }
+}
+
+export function registerCompileProfileCommands(context: vscode.ExtensionContext): void {
+  context.subscriptions.push(
+    vscode.commands.registerTextEditorCommand("fastolympiccoding.profileCompilation", (editor) =>
+      profileCompilation(editor.document.fileName)
+    )
+  );
+}
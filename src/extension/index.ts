@@ -1,20 +1,29 @@
 import * as fs from "node:fs/promises";
 import * as path from "node:path";
+import { performance } from "node:perf_hooks";
 import * as vscode from "vscode";
 
-import { compile, clearCompileCache } from "./utils/runtime";
+import { compile, clearCompileCache, preloadProcessMonitor } from "./utils/runtime";
 import { createListener, stopCompetitiveCompanion } from "./competitiveCompanion";
 import { registerRunSettingsCommands } from "./runSettingsCommands";
+import { registerBenchmarkCommands } from "./benchmark";
+import { registerCalibrationCommands } from "./calibration";
+import { registerGenerationCommands } from "./testcaseGeneration";
+import { registerBatchJudgeCommands } from "./batchJudge";
+import { registerCompileProfileCommands } from "./compileProfile";
+import { registerLineCountCommands } from "./lineCounts";
 import {
   initializeRunSettingsWatcher,
   ReadonlyStringProvider,
   resolveVariables,
 } from "./utils/vscode";
-import { initLogging } from "./utils/logging";
+import { getLogger, initLogging } from "./utils/logging";
+import { initLagMonitor } from "./utils/lagMonitor";
 import { TemplateFoldingProvider } from "./utils/folding";
 import JudgeViewProvider from "./providers/JudgeViewProvider";
 import StressViewProvider from "./providers/StressViewProvider";
 import PanelViewProvider from "./providers/PanelViewProvider";
+import { WEBVIEW_OPTIONS } from "./providers/BaseViewProvider";
 import { showChangelog } from "./changelog";
 import { createStatusBarItem } from "./statusBar";
 
@@ -98,12 +107,16 @@ async function getTemplateContent(
 function registerViewProviders(context: vscode.ExtensionContext): void {
   judgeViewProvider = new JudgeViewProvider(context);
   context.subscriptions.push(
-    vscode.window.registerWebviewViewProvider(judgeViewProvider.getViewId(), judgeViewProvider)
+    vscode.window.registerWebviewViewProvider(judgeViewProvider.getViewId(), judgeViewProvider, {
+      webviewOptions: WEBVIEW_OPTIONS,
+    })
   );
 
   stressViewProvider = new StressViewProvider(context, judgeViewProvider);
   context.subscriptions.push(
-    vscode.window.registerWebviewViewProvider(stressViewProvider.getViewId(), stressViewProvider)
+    vscode.window.registerWebviewViewProvider(stressViewProvider.getViewId(), stressViewProvider, {
+      webviewOptions: WEBVIEW_OPTIONS,
+    })
   );
 
   // Panel tree view in panel area (bottom)
@@ -153,6 +166,12 @@ function registerFoldingProvider(context: vscode.ExtensionContext): void {
 
 function registerCommands(context: vscode.ExtensionContext): void {
   registerRunSettingsCommands(context);
+  registerBenchmarkCommands(context, judgeViewProvider);
+  registerCalibrationCommands(context);
+  registerGenerationCommands(context, judgeViewProvider);
+  registerBatchJudgeCommands(context, judgeViewProvider);
+  registerCompileProfileCommands(context);
+  registerLineCountCommands(context);
 
   const compilationStatusItem = vscode.window.createStatusBarItem(
     vscode.StatusBarAlignment.Right,
@@ -311,6 +330,12 @@ function registerCommands(context: vscode.ExtensionContext): void {
     )
   );
 
+  context.subscriptions.push(
+    vscode.commands.registerCommand("fastolympiccoding.showStressSizeReport", () =>
+      stressViewProvider.showSizeReport()
+    )
+  );
+
   context.subscriptions.push(
     vscode.commands.registerTextEditorCommand("fastolympiccoding.clearData", () => {
       judgeViewProvider.clearData();
@@ -481,25 +506,68 @@ function registerCommands(context: vscode.ExtensionContext): void {
         await stopCompetitiveCompanion();
         createListener(judgeViewProvider);
       }
+      if (e.affectsConfiguration("fastolympiccoding.timeMultiplier")) {
+        judgeViewProvider.refreshLimits();
+      }
     })
   );
 }
 
-export function activate(context: vscode.ExtensionContext): void {
-  initLogging(context);
-  initializeRunSettingsWatcher(context);
-  void showChangelog(context, true);
+// Delay before work that no command depends on right away, so it doesn't compete with the
+// rest of the window starting up
+const DEFERRED_STARTUP_DELAY_MS = 1000;
+
+// Times each activation phase for the startup breakdown in the log
+function createPhaseTimer(): {
+  phase: <T>(name: string, fn: () => T) => T;
+  summary: () => string;
+} {
+  const phases: string[] = [];
+  const start = performance.now();
+  return {
+    phase: (name, fn) => {
+      const phaseStart = performance.now();
+      const result = fn();
+      phases.push(`${name} ${(performance.now() - phaseStart).toFixed(1)}ms`);
+      return result;
+    },
+    summary: () => `${(performance.now() - start).toFixed(1)}ms (${phases.join(", ")})`,
+  };
+}
 
-  registerViewProviders(context);
-  registerCommands(context);
-  registerDocumentContentProviders(context);
-  registerFoldingProvider(context);
+function scheduleDeferredStartup(context: vscode.ExtensionContext): void {
+  const timeout = setTimeout(() => {
+    const timer = createPhaseTimer();
+    timer.phase("process monitor", () => context.subscriptions.push(preloadProcessMonitor()));
+    timer.phase("changelog", () => void showChangelog(context, true));
 
-  createStatusBarItem(context);
+    const config = vscode.workspace.getConfiguration("fastolympiccoding");
+    const autoStart = config.get<boolean>("automaticallyStartCompetitiveCompanion", true);
+    if (autoStart) {
+      timer.phase("competitive companion", () => createListener(judgeViewProvider));
+    }
+    getLogger("extension").info(`Deferred startup work took ${timer.summary()}`);
+  }, DEFERRED_STARTUP_DELAY_MS);
+  context.subscriptions.push(new vscode.Disposable(() => clearTimeout(timeout)));
+}
 
-  const config = vscode.workspace.getConfiguration("fastolympiccoding");
-  const autoStart = config.get<boolean>("automaticallyStartCompetitiveCompanion", true);
-  if (autoStart) {
-    createListener(judgeViewProvider);
-  }
+export function activate(context: vscode.ExtensionContext): void {
+  const timer = createPhaseTimer();
+  timer.phase("logging", () => {
+    initLogging(context);
+    initLagMonitor(context);
+  });
+  timer.phase("run settings", () => initializeRunSettingsWatcher(context));
+
+  // Only registration happens here: per-file state is parsed when a view is first shown
+  timer.phase("views", () => registerViewProviders(context));
+  timer.phase("commands", () => {
+    registerCommands(context);
+    registerDocumentContentProviders(context);
+    registerFoldingProvider(context);
+  });
+  timer.phase("status bar", () => createStatusBarItem(context));
+
+  scheduleDeferredStartup(context);
+  getLogger("extension").info(`Activated in ${timer.summary()}`);
 }
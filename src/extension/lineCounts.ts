@@ -0,0 +1,379 @@
+import * as fs from "node:fs/promises";
+import * as path from "node:path";
+import * as vscode from "vscode";
+
+import { detectCompiler, runCommand, type Compiler } from "./compileProfile";
+import {
+  compileVariant,
+  createScratchDirectory,
+  removeScratchDirectory,
+  Runnable,
+} from "./utils/runtime";
+import { getFileRunSettings } from "./utils/vscode";
+import { getLogger } from "./utils/logging";
+
+type LineCounts = Map<number, number>; // 1-based line to execution count
+
+type GcovFile = {
+  file: string;
+  lines: { line_number: number; count: number }[];
+};
+
+type GcovDocument = {
+  current_working_directory: string;
+  files: GcovFile[];
+};
+
+// [line, column, count, hasCount, isRegionEntry, isGapRegion]
+type LlvmSegment = [number, number, number, boolean, boolean, boolean];
+
+type LlvmExport = {
+  data: { files: { filename: string; segments: LlvmSegment[] }[] }[];
+};
+
+// gcov maps optimized code back to very few lines, so GCC builds drop to -O0. Clang's
+// source-based coverage counts regions exactly at any optimization level.
+const COVERAGE_FLAGS: Record<Compiler, string[]> = {
+  gcc: ["--coverage", "-O0"],
+  clang: ["-fprofile-instr-generate", "-fcoverage-mapping"],
+};
+
+const PROFRAW_NAME = "line-counts.profraw";
+const HEAT_LEVELS = 5;
+
+// Decorations for the file shown last, reapplied whenever an editor shows it again
+let shown: { file: string; counts: LineCounts } | undefined;
+let heatDecorations: vscode.TextEditorDecorationType[] = [];
+
+function llvmTool(name: string): string[] {
+  // Xcode ships the LLVM tools without putting them on PATH
+  return process.platform === "darwin" ? ["xcrun", name] : [name];
+}
+
+function isSameFile(a: string, b: string): boolean {
+  return path.resolve(a) === path.resolve(b);
+}
+
+// Inlined and template code reports the same line once per function, so counts add up
+function addCount(counts: LineCounts, line: number, count: number) {
+  counts.set(line, (counts.get(line) ?? 0) + count);
+}
+
+/**
+ * Reads gcov's JSON output, one document per data file. Source paths are relative to the
+ * directory the compiler ran in.
+ */
+function parseGcov(output: string, file: string): LineCounts {
+  const counts: LineCounts = new Map();
+  for (const line of output.split("\n")) {
+    if (line.trim() === "") {
+      continue;
+    }
+    const document = JSON.parse(line) as GcovDocument;
+    for (const source of document.files) {
+      if (!isSameFile(path.resolve(document.current_working_directory, source.file), file)) {
+        continue;
+      }
+      for (const { line_number, count } of source.lines) {
+        addCount(counts, line_number, count);
+      }
+    }
+  }
+  return counts;
+}
+
+/**
+ * Turns llvm-cov segments into line counts the way `llvm-cov show` does: a line takes the
+ * largest count of the regions starting on it, otherwise the count of the region it is in.
+ */
+function parseLlvmExport(output: string, file: string): LineCounts {
+  const counts: LineCounts = new Map();
+  const exported = JSON.parse(output) as LlvmExport;
+  for (const source of exported.data.flatMap((data) => data.files)) {
+    if (!isSameFile(source.filename, file) || source.segments.length === 0) {
+      continue;
+    }
+
+    const segments = source.segments;
+    let wrapped: LlvmSegment | undefined;
+    let next = 0;
+    const lastLine = segments[segments.length - 1][0];
+    for (let line = segments[0][0]; line <= lastLine; line++) {
+      const starts: LlvmSegment[] = [];
+      while (next < segments.length && segments[next][0] === line) {
+        starts.push(segments[next++]);
+      }
+
+      const entries = starts.filter(([, , , hasCount, isRegionEntry]) => hasCount && isRegionEntry);
+      if (entries.length > 0) {
+        counts.set(line, Math.max(...entries.map(([, , count]) => count)));
+      } else if (wrapped?.[3] && !wrapped[5]) {
+        counts.set(line, wrapped[2]);
+      }
+      if (starts.length > 0) {
+        wrapped = starts[starts.length - 1];
+      }
+    }
+  }
+  return counts;
+}
+
+// gcc >= 11 names notes after the output and the source, older versions after the source
+async function findGcovNotes(gcda: string, directories: string[]): Promise<string | null> {
+  const name = `${path.basename(gcda, ".gcda")}.gcno`;
+  for (const directory of directories) {
+    const candidate = path.join(directory, name);
+    try {
+      await fs.access(candidate);
+      return candidate;
+    } catch {
+      // try the next directory
+    }
+  }
+  return null;
+}
+
+async function readGcovCounts(
+  file: string,
+  scratchDirectory: string,
+  binaryDirectory: string,
+  compileDirectory: string
+): Promise<LineCounts | string> {
+  const dataFiles = (await fs.readdir(scratchDirectory)).filter((name) => name.endsWith(".gcda"));
+  if (dataFiles.length === 0) {
+    return "The instrumented build wrote no coverage data";
+  }
+  for (const dataFile of dataFiles) {
+    const notes = await findGcovNotes(dataFile, [binaryDirectory, compileDirectory]);
+    if (notes) {
+      await fs.copyFile(notes, path.join(scratchDirectory, path.basename(notes)));
+    }
+  }
+
+  const result = await runCommand(
+    ["gcov", "--json-format", "--stdout", ...dataFiles],
+    scratchDirectory
+  );
+  if (result.exitCode !== 0) {
+    getLogger("judge").error(`gcov failed: ${result.stderr}`);
+    return "gcov failed, line counts need GCC 10 or newer";
+  }
+  return parseGcov(result.stdout, file);
+}
+
+async function readLlvmCounts(
+  file: string,
+  scratchDirectory: string,
+  binary: string
+): Promise<LineCounts | string> {
+  const profdata = path.join(scratchDirectory, "line-counts.profdata");
+  const merge = await runCommand([
+    ...llvmTool("llvm-profdata"),
+    "merge",
+    "-sparse",
+    path.join(scratchDirectory, PROFRAW_NAME),
+    "-o",
+    profdata,
+  ]);
+  if (merge.exitCode !== 0) {
+    getLogger("judge").error(`llvm-profdata failed: ${merge.stderr}`);
+    return "llvm-profdata failed, is it installed next to clang?";
+  }
+
+  const exported = await runCommand([
+    ...llvmTool("llvm-cov"),
+    "export",
+    "-format=text",
+    "-skip-expansions",
+    `-instr-profile=${profdata}`,
+    binary,
+  ]);
+  if (exported.exitCode !== 0) {
+    getLogger("judge").error(`llvm-cov failed: ${exported.stderr}`);
+    return "llvm-cov failed, is it installed next to clang?";
+  }
+  return parseLlvmExport(exported.stdout, file);
+}
+
+/**
+ * Builds the coverage variant (through the compile cache), runs it on the input in a
+ * scratch directory, and reads back the execution count of every line. Returns an error
+ * message on failure, or null when cancelled.
+ */
+async function collectLineCounts(
+  file: string,
+  stdin: string,
+  context: vscode.ExtensionContext,
+  token: vscode.CancellationToken
+): Promise<LineCounts | string | null> {
+  const settings = getFileRunSettings(file);
+  const compileCommand = settings?.languageSettings.compileCommand;
+  if (!settings || !compileCommand) {
+    return `No compile command for ${path.basename(file)}`;
+  }
+  const compiler = await detectCompiler(compileCommand[0]);
+  if (!compiler) {
+    return `Line counts support GCC and Clang, not ${compileCommand[0]}`;
+  }
+
+  const variant = compileVariant(file, COVERAGE_FLAGS[compiler], context);
+  if (!variant) {
+    return "Line counts need a compile command that writes to ${fileBasenameNoExtension}";
+  }
+  const compilation = await variant.result;
+  if (compilation.code !== 0) {
+    getLogger("judge").error(`Coverage build failed (file=${file}): ${compilation.stderr}`);
+    return `Failed to compile ${path.basename(file)} with coverage`;
+  }
+
+  const runCommandLine = variant.languageSettings.runCommand!;
+  const compileDirectory = variant.languageSettings.currentWorkingDirectory ?? path.dirname(file);
+  const binary = path.resolve(compileDirectory, runCommandLine[0]);
+  const scratchDirectory = await createScratchDirectory(settings.inputFile, stdin);
+  try {
+    // Coverage data goes to the scratch directory, so runs don't merge into each other
+    const env: Record<string, string> =
+      compiler === "gcc"
+        ? { GCOV_PREFIX: scratchDirectory, GCOV_PREFIX_STRIP: "1000" }
+        : { LLVM_PROFILE_FILE: path.join(scratchDirectory, PROFRAW_NAME) };
+    const runnable = new Runnable();
+    const subscription = token.onCancellationRequested(() => runnable.stop());
+    runnable
+      .on("spawn", () => runnable.stdin?.end(stdin))
+      .run(runCommandLine, 0, 0, scratchDirectory, { env });
+    await runnable.done;
+    subscription.dispose();
+    void runnable.dispose();
+    if (token.isCancellationRequested) {
+      return null;
+    }
+    // Counters are only written on a normal exit, which includes a non-zero exit code
+    if (runnable.termination !== "exit" && runnable.exitCode === null) {
+      return `The instrumented run did not exit normally (${runnable.termination})`;
+    }
+
+    return compiler === "gcc"
+      ? await readGcovCounts(file, scratchDirectory, path.dirname(binary), compileDirectory)
+      : await readLlvmCounts(file, scratchDirectory, binary);
+  } finally {
+    await removeScratchDirectory(scratchDirectory);
+  }
+}
+
+function formatCount(count: number): string {
+  return count.toLocaleString("en-US");
+}
+
+function createHeatDecorations(): vscode.TextEditorDecorationType[] {
+  return Array.from({ length: HEAT_LEVELS }, (_, level) =>
+    vscode.window.createTextEditorDecorationType({
+      isWholeLine: true,
+      backgroundColor: `rgba(255, 96, 0, ${((level + 1) * 0.3) / HEAT_LEVELS})`,
+      overviewRulerColor: level >= HEAT_LEVELS - 2 ? "rgba(255, 96, 0, 0.8)" : undefined,
+      overviewRulerLane: vscode.OverviewRulerLane.Right,
+    })
+  );
+}
+
+// Heat is logarithmic, so a loop running 10^9 times stands out from one running 10^6 times
+function applyDecorations(editor: vscode.TextEditor, counts: LineCounts) {
+  const max = Math.max(...counts.values(), 1);
+  const byLevel: vscode.DecorationOptions[][] = heatDecorations.map(() => []);
+  for (const [line, count] of counts) {
+    if (line < 1 || line > editor.document.lineCount) {
+      continue;
+    }
+    const heat = count > 0 ? Math.log10(count + 1) / Math.log10(max + 1) : 0;
+    const level = Math.min(Math.floor(heat * HEAT_LEVELS), HEAT_LEVELS - 1);
+    const end = editor.document.lineAt(line - 1).range.end;
+    byLevel[level].push({
+      range: new vscode.Range(end, end),
+      hoverMessage: `Executed ${formatCount(count)} times`,
+      renderOptions: {
+        after: {
+          contentText: `× ${formatCount(count)}`,
+          color: new vscode.ThemeColor("editorCodeLens.foreground"),
+          margin: "0 0 0 2em",
+        },
+      },
+    });
+  }
+  heatDecorations.forEach((decoration, level) => editor.setDecorations(decoration, byLevel[level]));
+}
+
+function clearLineCounts() {
+  shown = undefined;
+  for (const editor of vscode.window.visibleTextEditors) {
+    for (const decoration of heatDecorations) {
+      editor.setDecorations(decoration, []);
+    }
+  }
+}
+
+/**
+ * Shows how many times every line of the file ran on the given input, as a heatmap in the
+ * editor. Interactive testcases aren't supported, the instrumented run has no interactor.
+ */
+export async function showLineCounts(
+  file: string,
+  stdin: string,
+  label: string,
+  context: vscode.ExtensionContext
+): Promise<void> {
+  const counts = await vscode.window.withProgress(
+    {
+      location: vscode.ProgressLocation.Notification,
+      title: `Counting line executions of ${path.basename(file)} on ${label}`,
+      cancellable: true,
+    },
+    (_, token) => collectLineCounts(file, stdin, context, token)
+  );
+  if (counts === null) {
+    return;
+  }
+  if (typeof counts === "string") {
+    await vscode.window.showErrorMessage(counts);
+    return;
+  }
+  if (counts.size === 0) {
+    await vscode.window.showWarningMessage(`No line counts were recorded for ${path.basename(file)}`);
+    return;
+  }
+
+  const total = [...counts.values()].reduce((sum, count) => sum + count, 0);
+  getLogger("judge").info(
+    `Counted ${formatCount(total)} line executions over ${counts.size} lines of ${file}`
+  );
+  clearLineCounts();
+  shown = { file, counts };
+  const editor = await vscode.window.showTextDocument(vscode.Uri.file(file), {
+    preserveFocus: true,
+    preview: false,
+  });
+  applyDecorations(editor, counts);
+}
+
+export function registerLineCountCommands(context: vscode.ExtensionContext): void {
+  heatDecorations = createHeatDecorations();
+  context.subscriptions.push(
+    ...heatDecorations,
+    vscode.commands.registerCommand("fastolympiccoding.clearLineCounts", clearLineCounts),
+    vscode.window.onDidChangeVisibleTextEditors((editors) => {
+      for (const editor of editors) {
+        if (shown && isSameFile(editor.document.fileName, shown.file)) {
+          applyDecorations(editor, shown.counts);
+        }
+      }
+    }),
+    // Counts go stale as soon as the source changes
+    vscode.workspace.onDidChangeTextDocument((event) => {
+      if (
+        shown &&
+        event.contentChanges.length > 0 &&
+        isSameFile(event.document.fileName, shown.file)
+      ) {
+        clearLineCounts();
+      }
+    })
+  );
+}
@@ -5,6 +5,9 @@ import { getLogger } from "../utils/logging";
 
 type WorkspaceState = Record<string, unknown>;
 
+// Hidden views keep their page alive, so showing one again doesn't reload and re-render it
+export const WEBVIEW_OPTIONS = { retainContextWhenHidden: true } as const;
+
 function getNonce(): string {
   const CHOICES = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
   let nonce = "";
@@ -48,6 +51,9 @@ export default abstract class BaseViewProvider<
     // Intercept LOADED message to resolve the view ready promise
     if (typeof msg === "object" && msg !== null && "type" in msg && msg.type === "LOADED") {
       this._resolveViewReady();
+      if ("startupMs" in msg && typeof msg.startupMs === "number") {
+        getLogger(this.view).info(`Webview interactive in ${msg.startupMs.toFixed(1)}ms`);
+      }
     }
     this.handleMessage(msg);
   }
@@ -75,6 +81,14 @@ export default abstract class BaseViewProvider<
     this._syncOrSwitchToCurrentFile();
   }
 
+  // Per-file state is parsed when the view is first shown rather than at activation, so
+  // commands that can run before that load it themselves
+  protected _ensureCurrentFileLoaded(): void {
+    if (!this._onDidChangeActiveTextEditorDisposable) {
+      this.loadCurrentFileData();
+    }
+  }
+
   protected _ensureActiveEditorListener(): void {
     if (this._onDidChangeActiveTextEditorDisposable) {
       return;
@@ -154,9 +168,16 @@ export default abstract class BaseViewProvider<
     });
     webviewView.onDidDispose(() => this.onDispose());
     webviewView.onDidChangeVisibility(() => {
-      if (webviewView.visible) {
-        this.onShow();
+      if (!webviewView.visible) {
+        return;
+      }
+      // A retained page kept receiving updates while hidden, including file switches from the
+      // editor listener, so it is already current
+      if (WEBVIEW_OPTIONS.retainContextWhenHidden && this._onDidChangeActiveTextEditorDisposable) {
+        getLogger(this.view).trace("Resumed retained webview");
+        return;
       }
+      this.onShow();
     });
   }
 
@@ -203,6 +224,7 @@ export default abstract class BaseViewProvider<
     const scriptUri = this._getUri(webview, ["dist", this.view, "index.js"]);
     const stylesUri = this._getUri(webview, ["dist", this.view, "index.css"]);
     const codiconsUri = this._getUri(webview, ["dist", "codicons", "codicon.css"]);
+    const publicPath = `${this._getUri(webview, ["dist"])}/`;
     const nonce = getNonce();
 
     return `
@@ -216,7 +238,7 @@ export default abstract class BaseViewProvider<
                 <link rel="stylesheet" href="${codiconsUri}">
             </head>
         <body>
-            <div id="root"></div>
+            <div id="root" data-public-path="${publicPath}" data-nonce="${nonce}"></div>
             <script type="module" nonce="${nonce}" src="${scriptUri}"></script>
         </body>
         </html>
@@ -1,6 +1,7 @@
 import * as vscode from "vscode";
 import * as v from "valibot";
 import * as crypto from "crypto";
+import { performance } from "node:perf_hooks";
 
 import {
   TestcaseSchema,
@@ -11,13 +12,19 @@ import {
 import BaseViewProvider from "./BaseViewProvider";
 import {
   compile,
+  createScratchDirectory,
   findAvailablePort,
+  getMemoryPolicy,
+  getTimeLimitMode,
   mapTestcaseTermination,
+  readScratchOutput,
+  removeScratchDirectory,
+  CancelGroup,
   Runnable,
   severityNumberToInteractiveStatus,
   terminationSeverityNumber,
 } from "../utils/runtime";
-import type { Severity } from "../utils/runtime";
+import type { RunTermination, Severity } from "../utils/runtime";
 import {
   getAttachDebugConfiguration,
   getFileRunSettings,
@@ -31,6 +38,8 @@ import {
   type WriteMode,
 } from "../utils/vscode";
 import { getLogger } from "../utils/logging";
+import { getBenchmarkCpu, median } from "../benchmark";
+import { showLineCounts } from "../lineCounts";
 import {
   ActionMessageSchema,
   CopyMessageSchema,
@@ -47,7 +56,7 @@ import {
   ViewMessageSchema,
   type WebviewMessage,
 } from "../../shared/judge-messages";
-import type { Stdio } from "../../shared/enums";
+import type { Status, Stdio } from "../../shared/enums";
 
 type Testcase = v.InferOutput<typeof TestcaseSchema>;
 type FileData = v.InferOutput<typeof FileDataSchema>;
@@ -55,13 +64,21 @@ type ExportTestcase = Omit<Testcase, "uuid">;
 
 const TestcaseArraySchema = v.array(TestcaseSchema);
 
+const SubtaskSchema = v.object({
+  score: v.fallback(v.number(), 0),
+  dependencies: v.fallback(v.array(v.string()), []),
+});
+
+type Subtask = v.InferOutput<typeof SubtaskSchema>;
+
 const FileDataSchema = v.fallback(
   v.object({
     timeLimit: v.fallback(v.number(), 0),
     memoryLimit: v.fallback(v.number(), 0),
     testcases: v.fallback(v.array(TestcaseSchema), []),
+    subtasks: v.fallback(v.record(v.string(), SubtaskSchema), {}),
   }),
-  { timeLimit: 0, memoryLimit: 0, testcases: [] }
+  { timeLimit: 0, memoryLimit: 0, testcases: [], subtasks: {} }
 );
 
 type State = Omit<
@@ -84,6 +101,8 @@ interface RuntimeContext {
   state: State[];
   timeLimit: number;
   memoryLimit: number;
+  subtasks: Record<string, Subtask>;
+  cancelGroup: CancelGroup; // every testcase and interactor run of the file
 }
 
 type ExecutionContext = {
@@ -92,28 +111,213 @@ type ExecutionContext = {
   languageSettings: LanguageSettings;
   interactorArgs: string[] | null;
   cwd?: string;
+  inputFile?: string;
+  outputFile?: string;
   file: string;
+  cancelGroup: CancelGroup;
+};
+
+// Floor for the baseline budget so tiny baselines aren't killed by process startup jitter
+const MIN_BASELINE_BUDGET_MS = 100;
+
+// Returns the early-kill budget derived from the last accepted runtime, or 0 when it
+// doesn't apply (disabled, no baseline yet, or not tighter than the hard time limit).
+function getBaselineBudget(baselineElapsed: number, timeLimit: number): number {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  const factor = config.get<number>("baselineTimeFactor", 0);
+  if (factor <= 0 || baselineElapsed <= 0) {
+    return 0;
+  }
+  const budget = Math.max(Math.ceil(baselineElapsed * factor), MIN_BASELINE_BUDGET_MS);
+  return timeLimit === 0 || budget < timeLimit ? budget : 0;
+}
+
+// Ratio of judge time to local time, set by machine speed calibration
+export function getTimeMultiplier(): number {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  const multiplier = config.get<number>("timeMultiplier", 1);
+  return multiplier > 0 ? multiplier : 1;
+}
+
+// Converts a judge time limit into the local limit enforced by the process monitor
+export function getLocalTimeLimit(timeLimit: number): number {
+  return timeLimit === 0 ? 0 : Math.max(Math.round(timeLimit / getTimeMultiplier()), 1);
+}
+
+// Verdicts that a slower or faster run could flip between accepted and time limit exceeded
+const BORDERLINE_STATUSES: Status[] = ["AC", "WA", "NA", "TL"];
+
+// Half width of the band around the time limit, as a fraction, or 0 when reruns are disabled
+function getBorderlineBand(): number {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return Math.max(config.get<number>("borderlineBand", 15), 0) / 100;
+}
+
+function getBorderlineReruns(): number {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return Math.max(config.get<number>("borderlineReruns", 5), 1);
+}
+
+// Whether the run finished close enough to the local time limit that noise could decide it
+function isBorderline(state: State, timeLimit: number): boolean {
+  const band = getBorderlineBand();
+  if (band <= 0 || timeLimit === 0 || !BORDERLINE_STATUSES.includes(state.status)) {
+    return false;
+  }
+  return state.elapsed >= timeLimit * (1 - band) && state.elapsed <= timeLimit * (1 + band);
+}
+
+type BorderlineSample = {
+  elapsed: number;
+  termination: RunTermination;
+  stdout: Buffer;
 };
 
-function updateTestcaseFromTermination(state: State) {
+// Runs the testcase once more on the pinned core, or returns null if it can't be set up
+async function rerunTestcase(
+  stdin: string,
+  languageSettings: LanguageSettings,
+  limits: { timeLimit: number; memoryLimit: number },
+  cwd: string | undefined,
+  inputFile: string | undefined,
+  outputFile: string | undefined,
+  token: vscode.CancellationToken,
+  cancelGroup: CancelGroup
+): Promise<BorderlineSample | null> {
+  let scratchDirectory: string | undefined;
+  if (inputFile || outputFile) {
+    try {
+      scratchDirectory = await createScratchDirectory(inputFile, stdin);
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      getLogger("judge").error(`Failed to prepare scratch directory: ${errorMessage}`);
+      return null;
+    }
+  }
+
+  const runnable = new Runnable();
+  const stdout = new TextHandler();
+  const cancellation = token.onCancellationRequested(() => runnable.stop());
+  runnable
+    .on("spawn", () => runnable.stdin?.end(stdin))
+    .on("stdout:bytes", (data: Buffer) => stdout.write(data, "batch"))
+    .on("stdout:end", () => stdout.write("", "final"))
+    .run(
+      languageSettings.runCommand!,
+      limits.timeLimit,
+      limits.memoryLimit,
+      scratchDirectory ?? cwd,
+      {
+        cpuAffinity: getBenchmarkCpu(),
+        timeLimitMode: getTimeLimitMode(),
+        runtimeProfile: languageSettings.runtimeProfile,
+        memoryPolicy: getMemoryPolicy(),
+        cancelGroup,
+      }
+    );
+  await runnable.done;
+  cancellation.dispose();
+  void runnable.dispose();
+
+  let output = stdout.bytes;
+  if (scratchDirectory) {
+    if (outputFile) {
+      const fileOutput = new TextHandler();
+      fileOutput.write(await readScratchOutput(scratchDirectory, outputFile), "final");
+      output = fileOutput.bytes;
+    }
+    await removeScratchDirectory(scratchDirectory);
+  }
+  return { elapsed: runnable.elapsed, termination: runnable.termination, stdout: output };
+}
+
+// Multithreaded solutions get their per-thread CPU times logged, to spot an unbalanced split
+function updateThreadStatistics(state: State) {
+  state.threadCount = state.process.threadCount;
+  state.parallelism = state.process.parallelism;
+  if (state.threadCount > 1) {
+    getLogger("judge").debug(
+      `Testcase ${state.uuid} used ${state.threadCount} threads (parallelism ${state.parallelism.toFixed(2)}), per-thread CPU ms: ${state.process.threadCpuTimes.join(", ")}`
+    );
+  }
+}
+
+// Verdicts that fail a subtask outright. NA means no accepted output to compare against.
+const SUBTASK_FAILURE_STATUSES: Status[] = ["CE", "RE", "WA", "TL", "ML", "SB"];
+
+// Orders subtask labels so every subtask comes after the ones it depends on. Dependencies
+// on labels without testcases are ignored. Returns null if the dependencies form a cycle.
+function orderSubtasks(
+  groups: Map<string, State[]>,
+  subtasks: Record<string, Subtask>
+): string[] | null {
+  const order: string[] = [];
+  const visiting = new Set<string>();
+  const visit = (label: string): boolean => {
+    if (order.includes(label)) {
+      return true;
+    }
+    if (visiting.has(label)) {
+      return false;
+    }
+    visiting.add(label);
+    for (const dependency of subtasks[label]?.dependencies ?? []) {
+      if (groups.has(dependency) && !visit(dependency)) {
+        return false;
+      }
+    }
+    visiting.delete(label);
+    order.push(label);
+    return true;
+  };
+  for (const label of groups.keys()) {
+    if (!visit(label)) {
+      return null;
+    }
+  }
+  return order;
+}
+
+function updateTestcaseFromTermination(state: State, baselineLimited: boolean) {
   state.elapsed = state.process.elapsed;
   state.memoryBytes = state.process.maxMemoryBytes;
+  updateThreadStatistics(state);
+  // Part of memoryBytes, worth knowing when comparing against a judge with another policy
+  if (state.process.hugePageBytes > 0) {
+    getLogger("judge").debug(
+      `Testcase ${state.uuid} had up to ${state.process.hugePageBytes} bytes in transparent huge pages`
+    );
+  }
   state.status = mapTestcaseTermination(state.process.termination);
-  if (state.status === "NA") {
+  if (state.status === "TL" && baselineLimited) {
+    state.status = "SB";
+  } else if (state.status === "NA") {
     // Exit succeeded; refine with output comparison
-    if (state.acceptedStdout.isEmpty()) {
-      state.status = "NA";
-    } else if (state.stdout.data === state.acceptedStdout.data) {
-      state.status = "AC";
-    } else {
-      state.status = "WA";
-    }
+    state.status = compareWithAccepted(state);
+  }
+}
+
+function compareWithAccepted(state: State): Status {
+  if (state.acceptedStdout.isEmpty()) {
+    return "NA";
+  }
+  return state.stdout.bytes.equals(state.acceptedStdout.bytes) ? "AC" : "WA";
+}
+
+// After an edit to stdin or the accepted output. The time and verdict of borderline reruns
+// outlast the first run's, so only their output comparison is redone.
+function updateTestcaseAfterEdit(state: State) {
+  if (state.borderlineRuns.length === 0) {
+    updateTestcaseFromTermination(state, state.status === "SB");
+  } else if (state.status === "AC" || state.status === "WA" || state.status === "NA") {
+    state.status = compareWithAccepted(state);
   }
 }
 
 function updateInteractiveTestcaseFromTermination(state: State) {
   state.elapsed = state.process.elapsed;
   state.memoryBytes = state.process.maxMemoryBytes;
+  updateThreadStatistics(state);
   state.status = severityNumberToInteractiveStatus(
     Math.max(
       terminationSeverityNumber(state.process.termination) as number,
@@ -136,6 +340,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
   private _contexts: Map<string, RuntimeContext> = new Map();
 
   private _activeDebugTestcaseUuid?: string;
+  private _borderlineQueue: Promise<void> = Promise.resolve();
 
   private _onDidChangeBackgroundTasks = new vscode.EventEmitter<void>();
   readonly onDidChangeBackgroundTasks = this._onDidChangeBackgroundTasks.event;
@@ -155,6 +360,11 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       skipped: testcase.skipped,
       mode: testcase.mode,
       interactorSecret: testcase.interactorSecret.data,
+      baselineElapsed: testcase.baselineElapsed,
+      subtask: testcase.subtask,
+      threadCount: testcase.threadCount,
+      parallelism: testcase.parallelism,
+      borderlineRuns: testcase.borderlineRuns,
     }));
   }
 
@@ -172,6 +382,11 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       skipped: testcase.skipped,
       mode: testcase.mode,
       interactorSecret: testcase.interactorSecret,
+      baselineElapsed: testcase.baselineElapsed,
+      subtask: testcase.subtask,
+      threadCount: testcase.threadCount,
+      parallelism: testcase.parallelism,
+      borderlineRuns: testcase.borderlineRuns,
     }));
   }
 
@@ -197,6 +412,8 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       state,
       timeLimit: fileData.timeLimit,
       memoryLimit: fileData.memoryLimit,
+      subtasks: fileData.subtasks,
+      cancelGroup: new CancelGroup(),
     };
     this._contexts.set(file, context);
     return context;
@@ -229,9 +446,37 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       skipped: testcase.skipped,
       mode: testcase.mode,
       interactorSecret: testcase.interactorSecret,
+      baselineElapsed: testcase.baselineElapsed,
+      subtask: testcase.subtask,
+      threadCount: testcase.threadCount,
+      parallelism: testcase.parallelism,
+      borderlineRuns: testcase.borderlineRuns,
     }));
   }
 
+  // Files with at least one testcase, whether loaded or only in storage
+  public getFilesWithTestcases(): string[] {
+    const files = new Set<string>();
+    for (const file of Object.keys(super.readStorage())) {
+      if (this._parseFileDataFromStorage(file).testcases.length > 0) {
+        files.add(file);
+      }
+    }
+    for (const [file, context] of this._contexts) {
+      if (context.state.length > 0) {
+        files.add(file);
+      } else {
+        files.delete(file);
+      }
+    }
+    return [...files].sort();
+  }
+
+  public getLimitsForFile(file: string): { timeLimit: number; memoryLimit: number } {
+    const context = this._contexts.get(file) ?? this._parseFileDataFromStorage(file);
+    return { timeLimit: context.timeLimit, memoryLimit: context.memoryLimit };
+  }
+
   public appendImportedTestcasesForFile(file: string, rawData: unknown): number {
     const result = v.safeParse(TestcaseArraySchema, rawData);
     if (!result.success) {
@@ -399,7 +644,10 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       languageSettings: settings.languageSettings,
       interactorArgs,
       cwd: settings.languageSettings.currentWorkingDirectory,
+      inputFile: settings.inputFile,
+      outputFile: settings.outputFile,
       file: this._currentFile,
+      cancelGroup: this._runtime.cancelGroup,
     };
   }
 
@@ -458,10 +706,20 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       },
       file
     );
+    testcase.borderlineRuns = [];
+    super._postMessage(
+      {
+        type: "SET",
+        uuid: testcase.uuid,
+        property: "borderlineRuns",
+        value: [],
+      },
+      file
+    );
   }
 
   private async _launchTestcase(ctx: ExecutionContext, bypassLimits: boolean, debugMode: boolean) {
-    const { token, testcase, languageSettings, cwd } = ctx;
+    const { token, testcase, languageSettings, inputFile, outputFile } = ctx;
     if (!debugMode && !languageSettings.runCommand) {
       const logger = getLogger("judge");
       logger.error(`No run command for ${this._currentFile}`);
@@ -476,14 +734,52 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       return;
     }
 
+    // File I/O problems run in a private scratch directory so parallel runs don't share files
+    let scratchDirectory: string | undefined;
+    if (inputFile || outputFile) {
+      try {
+        scratchDirectory = await createScratchDirectory(inputFile, testcase.stdin.data);
+      } catch (error) {
+        const errorMessage = error instanceof Error ? error.message : String(error);
+        getLogger("judge").error(`Failed to prepare scratch directory: ${errorMessage}`);
+        testcase.stderr.write(errorMessage, "final");
+        testcase.status = "RE";
+        super._postMessage(
+          {
+            type: "SET",
+            uuid: testcase.uuid,
+            property: "status",
+            value: "RE",
+          },
+          ctx.file
+        );
+        return;
+      }
+    }
+    const cwd = scratchDirectory ?? ctx.cwd;
+
+    const timeLimit = bypassLimits ? 0 : getLocalTimeLimit(this._runtime.timeLimit);
+    const memoryLimit = bypassLimits ? 0 : this._runtime.memoryLimit;
+    const baselineBudget =
+      bypassLimits || debugMode ? 0 : getBaselineBudget(testcase.baselineElapsed, timeLimit);
+
     testcase.process
       .on("spawn", () => {
         testcase.process.stdin?.write(testcase.stdin.data);
       })
-      .on("stderr:data", (data: string) => testcase.stderr.write(data, "batch"))
-      .on("stdout:data", (data: string) => testcase.stdout.write(data, "batch"))
+      .on("stderr:bytes", (data: Buffer) => testcase.stderr.write(data, "batch"))
+      .on("stdout:bytes", (data: Buffer) => {
+        // With a declared output file, standard output isn't part of the answer
+        if (!outputFile) {
+          testcase.stdout.write(data, "batch");
+        }
+      })
       .on("stderr:end", () => testcase.stderr.write("", "final"))
-      .on("stdout:end", () => testcase.stdout.write("", "final"))
+      .on("stdout:end", () => {
+        if (!outputFile) {
+          testcase.stdout.write("", "final");
+        }
+      })
       .on("error", (data: Error) => {
         const logger = getLogger("judge");
         logger.error(`Process error during testcase execution: ${data.message}`);
@@ -499,46 +795,193 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
           ctx.file
         );
       })
-      .on("close", () => {
-        updateTestcaseFromTermination(testcase);
-        super._postMessage(
-          {
-            type: "SET",
-            uuid: testcase.uuid,
-            property: "status",
-            value: testcase.status,
-          },
-          ctx.file
-        );
-        super._postMessage(
-          {
-            type: "SET",
-            uuid: testcase.uuid,
-            property: "elapsed",
-            value: testcase.elapsed,
-          },
-          ctx.file
+      .run(
+        runCommand,
+        baselineBudget || timeLimit,
+        memoryLimit,
+        cwd,
+        {
+          timeLimitMode: getTimeLimitMode(),
+          runtimeProfile: languageSettings.runtimeProfile,
+          memoryPolicy: getMemoryPolicy(),
+          cancelGroup: ctx.cancelGroup,
+        }
+      );
+    this._onDidChangeBackgroundTasks.fire();
+
+    await testcase.process.done;
+    if (outputFile && scratchDirectory) {
+      testcase.stdout.write(await readScratchOutput(scratchDirectory, outputFile), "final");
+    }
+    updateTestcaseFromTermination(testcase, baselineBudget > 0);
+    if (testcase.status === "AC" && !debugMode) {
+      testcase.baselineElapsed = testcase.elapsed;
+      super._postMessage(
+        {
+          type: "SET",
+          uuid: testcase.uuid,
+          property: "baselineElapsed",
+          value: testcase.baselineElapsed,
+        },
+        ctx.file
+      );
+    }
+    super._postMessage(
+      {
+        type: "SET",
+        uuid: testcase.uuid,
+        property: "status",
+        value: testcase.status,
+      },
+      ctx.file
+    );
+    super._postMessage(
+      {
+        type: "SET",
+        uuid: testcase.uuid,
+        property: "elapsed",
+        value: testcase.elapsed,
+      },
+      ctx.file
+    );
+    super._postMessage(
+      {
+        type: "SET",
+        uuid: testcase.uuid,
+        property: "memoryBytes",
+        value: testcase.memoryBytes,
+      },
+      ctx.file
+    );
+    this._postThreadStatistics(testcase, ctx.file);
+    if (scratchDirectory) {
+      await removeScratchDirectory(scratchDirectory);
+    }
+    // The baseline budget kills before the limit, so its runs say nothing about borderline
+    if (!debugMode && baselineBudget === 0 && isBorderline(testcase, timeLimit)) {
+      await this._rerunBorderline(ctx, timeLimit, memoryLimit);
+    }
+    this.requestSave();
+  }
+
+  /**
+   * Reruns a testcase that finished near the time limit on a pinned core and takes the
+   * verdict from the median run, so a single noisy run doesn't decide between AC and TL.
+   * The reruns may exceed the limit by the borderline band, so their times stay comparable.
+   * A rerun killed even at that widened limit is a real TLE, and ends the reruns early.
+   */
+  private async _rerunBorderline(ctx: ExecutionContext, timeLimit: number, memoryLimit: number) {
+    const { token, testcase, languageSettings, inputFile, outputFile } = ctx;
+    const logger = getLogger("judge");
+    const firstStatus = testcase.status;
+    const firstElapsed = testcase.elapsed;
+    const runs = getBorderlineReruns();
+    const limits = { timeLimit: Math.ceil(timeLimit * (1 + getBorderlineBand())), memoryLimit };
+    // Stopping the file's background tasks cancels its group, and must also drop queued reruns
+    const generation = ctx.cancelGroup.generation;
+    const isCancelled = () =>
+      token.isCancellationRequested || ctx.cancelGroup.generation !== generation;
+
+    testcase.status = "RUNNING";
+    super._postMessage(
+      { type: "SET", uuid: testcase.uuid, property: "status", value: "RUNNING" },
+      ctx.file
+    );
+
+    // Reruns from every testcase share one core, so they go one at a time
+    const previous = this._borderlineQueue;
+    let release = () => {};
+    this._borderlineQueue = new Promise((resolve) => (release = () => resolve()));
+    const samples: BorderlineSample[] = [];
+    let exceeded: BorderlineSample | undefined;
+    try {
+      await previous;
+      while (samples.length < runs && !isCancelled()) {
+        const sample = await rerunTestcase(
+          testcase.stdin.data,
+          languageSettings,
+          limits,
+          ctx.cwd,
+          inputFile,
+          outputFile,
+          token,
+          ctx.cancelGroup
         );
+        if (!sample) {
+          break;
+        }
+        if (sample.termination === "timeout") {
+          exceeded = sample;
+          break;
+        }
+        samples.push(sample);
+      }
+    } finally {
+      release();
+    }
+
+    if (exceeded && !isCancelled()) {
+      // Over the limit by more than noise explains, so more reruns wouldn't change anything.
+      // The time is the rerun's that exceeded it.
+      testcase.status = "TL";
+      testcase.elapsed = Math.round(exceeded.elapsed);
+      testcase.borderlineRuns = [...samples, exceeded]
+        .map((sample) => sample.elapsed)
+        .sort((a, b) => a - b);
+      logger.info(
+        `Testcase ${testcase.uuid} took ${firstElapsed}ms of ${timeLimit}ms (${firstStatus}), rerun ${samples.length + 1} exceeded ${limits.timeLimit}ms: TL`
+      );
+    } else if (samples.length < runs || isCancelled()) {
+      // Keep the first run's verdict rather than one from an incomplete sample
+      testcase.status = firstStatus;
+    } else {
+      samples.sort((a, b) => a.elapsed - b.elapsed);
+      const elapsed = median(samples.map((sample) => sample.elapsed));
+      const middle = samples[Math.floor((samples.length - 1) / 2)];
+      testcase.elapsed = Math.round(elapsed);
+      testcase.borderlineRuns = samples.map((sample) => sample.elapsed);
+      if (elapsed > timeLimit) {
+        testcase.status = "TL";
+      } else {
+        testcase.status = mapTestcaseTermination(middle.termination);
+        if (testcase.status === "NA" && !testcase.acceptedStdout.isEmpty()) {
+          testcase.status = middle.stdout.equals(testcase.acceptedStdout.bytes) ? "AC" : "WA";
+        }
+      }
+      if (testcase.status === "AC") {
+        testcase.baselineElapsed = testcase.elapsed;
         super._postMessage(
           {
             type: "SET",
             uuid: testcase.uuid,
-            property: "memoryBytes",
-            value: testcase.memoryBytes,
+            property: "baselineElapsed",
+            value: testcase.baselineElapsed,
           },
           ctx.file
         );
-      })
-      .run(
-        runCommand,
-        bypassLimits ? 0 : this._runtime.timeLimit,
-        bypassLimits ? 0 : this._runtime.memoryLimit,
-        cwd
+      }
+      logger.info(
+        `Testcase ${testcase.uuid} took ${firstElapsed}ms of ${timeLimit}ms (${firstStatus}), median of ${runs} reruns ${testcase.elapsed}ms (${samples[0].elapsed}–${samples[samples.length - 1].elapsed}ms): ${testcase.status}`
       );
-    this._onDidChangeBackgroundTasks.fire();
+    }
 
-    await testcase.process.done;
-    this.requestSave();
+    super._postMessage(
+      { type: "SET", uuid: testcase.uuid, property: "status", value: testcase.status },
+      ctx.file
+    );
+    super._postMessage(
+      { type: "SET", uuid: testcase.uuid, property: "elapsed", value: testcase.elapsed },
+      ctx.file
+    );
+    super._postMessage(
+      {
+        type: "SET",
+        uuid: testcase.uuid,
+        property: "borderlineRuns",
+        value: testcase.borderlineRuns,
+      },
+      ctx.file
+    );
   }
 
   private async _launchInteractiveTestcase(
@@ -579,8 +1022,8 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         testcase.interactorSecretResolver?.();
         testcase.interactorSecretResolver = undefined;
       })
-      .on("stderr:data", (data: string) => testcase.stderr.write(data, "force"))
-      .on("stdout:data", (data: string) => {
+      .on("stderr:bytes", (data: Buffer) => testcase.stderr.write(data, "force"))
+      .on("stdout:bytes", (data: Buffer) => {
         testcase.stdout.write(data, "force");
         testcase.process.stdin?.write(data);
       })
@@ -596,8 +1039,8 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       });
 
     testcase.process
-      .on("stderr:data", (data: string) => testcase.stderr.write(data, "force"))
-      .on("stdout:data", async (data: string) => {
+      .on("stderr:bytes", (data: Buffer) => testcase.stderr.write(data, "force"))
+      .on("stdout:bytes", async (data: Buffer) => {
         if (testcase.interactorSecretResolver) {
           await secretPromise;
         }
@@ -614,12 +1057,18 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         testcase.interactorProcess.stop();
       });
 
-    testcase.interactorProcess.run(interactorArgs!, 0, 0, cwd);
+    testcase.interactorProcess.run(interactorArgs!, 0, 0, cwd, { cancelGroup: ctx.cancelGroup });
     testcase.process.run(
       runCommand,
-      bypassLimits ? 0 : this._runtime.timeLimit,
+      bypassLimits ? 0 : getLocalTimeLimit(this._runtime.timeLimit),
       bypassLimits ? 0 : this._runtime.memoryLimit,
-      cwd
+      cwd,
+      {
+        timeLimitMode: getTimeLimitMode(),
+        runtimeProfile: languageSettings.runtimeProfile,
+        memoryPolicy: getMemoryPolicy(),
+        cancelGroup: ctx.cancelGroup,
+      }
     );
     this._onDidChangeBackgroundTasks.fire();
 
@@ -657,10 +1106,32 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       },
       ctx.file
     );
+    this._postThreadStatistics(testcase, ctx.file);
     this._onDidChangeBackgroundTasks.fire();
     this.requestSave();
   }
 
+  private _postThreadStatistics(testcase: State, file: string) {
+    super._postMessage(
+      {
+        type: "SET",
+        uuid: testcase.uuid,
+        property: "threadCount",
+        value: testcase.threadCount,
+      },
+      file
+    );
+    super._postMessage(
+      {
+        type: "SET",
+        uuid: testcase.uuid,
+        property: "parallelism",
+        value: testcase.parallelism,
+      },
+      file
+    );
+  }
+
   protected handleMessage(msg: v.InferOutput<typeof ProviderMessageSchema>) {
     switch (msg.type) {
       case "LOADED":
@@ -748,8 +1219,6 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         }
       })
     );
-
-    this.onShow();
   }
 
   // Judge has state if there are testcases loaded
@@ -796,6 +1265,31 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     super._postMessage({ type: "SET", uuid, property: "toggled", value: testcase.toggled });
     super._postMessage({ type: "SET", uuid, property: "skipped", value: testcase.skipped });
     super._postMessage({ type: "SET", uuid, property: "mode", value: testcase.mode });
+    super._postMessage({
+      type: "SET",
+      uuid,
+      property: "baselineElapsed",
+      value: testcase.baselineElapsed,
+    });
+    super._postMessage({ type: "SET", uuid, property: "subtask", value: testcase.subtask });
+    super._postMessage({
+      type: "SET",
+      uuid,
+      property: "threadCount",
+      value: testcase.threadCount,
+    });
+    super._postMessage({
+      type: "SET",
+      uuid,
+      property: "parallelism",
+      value: testcase.parallelism,
+    });
+    super._postMessage({
+      type: "SET",
+      uuid,
+      property: "borderlineRuns",
+      value: testcase.borderlineRuns,
+    });
 
     const resendTruncatedData = (
       property: "stdin" | "stderr" | "stdout" | "acceptedStdout" | "interactorSecret",
@@ -824,15 +1318,9 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     this._sendShowMessage(true);
 
     // Rehydrate UI
-    const ctx = this._runtime;
+    this._postInitialState();
 
-    super._postMessage({
-      type: "INITIAL_STATE",
-      timeLimit: ctx.timeLimit,
-      memoryLimit: ctx.memoryLimit,
-    });
-
-    for (const testcase of ctx.state) {
+    for (const testcase of this._runtime.state) {
       super._postMessage({ type: "NEW", uuid: testcase.uuid });
       this._syncTestcaseState(testcase);
 
@@ -843,11 +1331,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
   }
 
   protected override _rehydrateWebviewFromState() {
-    super._postMessage({
-      type: "INITIAL_STATE",
-      timeLimit: this._runtime.timeLimit,
-      memoryLimit: this._runtime.memoryLimit,
-    });
+    this._postInitialState();
 
     for (const testcase of this._runtime.state) {
       const uuid = testcase.uuid;
@@ -859,6 +1343,22 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     }
   }
 
+  // Resends the limits and time multiplier, e.g. after calibration changed the multiplier
+  public refreshLimits() {
+    if (this._currentFile) {
+      this._postInitialState();
+    }
+  }
+
+  private _postInitialState() {
+    super._postMessage({
+      type: "INITIAL_STATE",
+      timeLimit: this._runtime.timeLimit,
+      memoryLimit: this._runtime.memoryLimit,
+      timeMultiplier: getTimeMultiplier(),
+    });
+  }
+
   addTestcaseToFile(file: string, testcase: Testcase, timeLimit?: number, memoryLimit?: number) {
     if (file === this._currentFile) {
       if (timeLimit !== undefined) {
@@ -868,11 +1368,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         this._runtime.memoryLimit = memoryLimit;
       }
       if (timeLimit !== undefined || memoryLimit !== undefined) {
-        super._postMessage({
-          type: "INITIAL_STATE",
-          timeLimit: this._runtime.timeLimit,
-          memoryLimit: this._runtime.memoryLimit,
-        });
+        this._postInitialState();
       }
 
       const state = this._addTestcase(testcase.mode, testcase);
@@ -904,30 +1400,122 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         timeLimit: fileData.timeLimit,
         memoryLimit: fileData.memoryLimit,
         testcases,
+        subtasks: fileData.subtasks,
       };
       void super.writeStorage(file, data);
     }
   }
 
   runAll() {
+    this._ensureCurrentFileLoaded();
+    if (this._runtime.state.some((testcase) => testcase.subtask !== "")) {
+      void this._runSubtasks(this._currentFile!);
+      return;
+    }
     for (const testcase of this._runtime.state) {
       void this._run(testcase.uuid, false);
     }
   }
 
+  // Ungrouped testcases run right away. A subtask starts once the subtasks it depends on
+  // finished and is skipped if any of them failed. Within a subtask, the first failing
+  // verdict stops the remaining testcases since the subtask scores nothing anyway.
+  private async _runSubtasks(file: string) {
+    const logger = getLogger("judge");
+    const runtime = this._runtime;
+    const groups = new Map<string, State[]>();
+    const ungrouped: Promise<void>[] = [];
+    for (const testcase of runtime.state) {
+      if (testcase.subtask === "") {
+        ungrouped.push(this._run(testcase.uuid, false));
+      } else {
+        groups.set(testcase.subtask, [...(groups.get(testcase.subtask) ?? []), testcase]);
+      }
+    }
+
+    const order = orderSubtasks(groups, runtime.subtasks);
+    if (!order) {
+      void vscode.window.showErrorMessage("Subtask dependencies form a cycle");
+      return;
+    }
+
+    const results = new Map<string, Promise<boolean>>();
+    const runGroup = async (label: string, members: State[]): Promise<boolean> => {
+      const dependencies = (runtime.subtasks[label]?.dependencies ?? []).filter((dependency) =>
+        groups.has(dependency)
+      );
+      const dependencyResults = await Promise.all(
+        dependencies.map((dependency) => results.get(dependency)!)
+      );
+      if (this._currentFile !== file) {
+        return false;
+      }
+      if (dependencyResults.includes(false)) {
+        logger.info(`Skipping subtask ${label} because a dependency failed`);
+        return false;
+      }
+
+      let failed = false;
+      await Promise.all(
+        members.map(async (testcase) => {
+          await this._run(testcase.uuid, false);
+          if (!failed && !testcase.skipped && SUBTASK_FAILURE_STATUSES.includes(testcase.status)) {
+            failed = true;
+            for (const other of members) {
+              if (other !== testcase) {
+                this._stop(other.uuid);
+              }
+            }
+          }
+        })
+      );
+      return !failed && members.every((testcase) => testcase.skipped || testcase.status === "AC");
+    };
+    for (const label of order) {
+      results.set(label, runGroup(label, groups.get(label)!));
+    }
+
+    const passed = await Promise.all(order.map((label) => results.get(label)!));
+    await Promise.all(ungrouped);
+    if (this._currentFile !== file) {
+      return;
+    }
+
+    let score = 0;
+    let total = 0;
+    const summary = order.map((label, i) => {
+      const points = runtime.subtasks[label]?.score ?? 0;
+      total += points;
+      score += passed[i] ? points : 0;
+      return `${label} ${passed[i] ? "passed" : "failed"}`;
+    });
+    logger.info(`Subtask score for ${file}: ${score}/${total} (${summary.join(", ")})`);
+    void vscode.window.showInformationMessage(`Score ${score}/${total}: ${summary.join(", ")}`);
+  }
+
   debugAll() {
+    this._ensureCurrentFileLoaded();
     for (const testcase of this._runtime.state) {
       void this._debug(testcase.uuid);
     }
   }
 
   stopAll() {
+    this._ensureCurrentFileLoaded();
+    if (!this._currentFile) {
+      return;
+    }
+    void this.stopBackgroundTasksForFile(this._currentFile);
+    // Debug sessions aren't in the file's cancel group
     for (const testcase of this._runtime.state) {
       this._stop(testcase.uuid);
     }
   }
 
   deleteAll(file?: string) {
+    if (!file) {
+      this._ensureCurrentFileLoaded();
+    }
     const currentFile = file ?? this._currentFile;
     if (!currentFile) {
       return;
@@ -961,6 +1549,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
   }
 
   openInteractorFile() {
+    this._ensureCurrentFileLoaded();
     if (!this._currentFile) {
       return;
     }
@@ -1005,10 +1594,12 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       return;
     }
 
-    // Stop all processes
+    // Stop all processes at once, however many are running, borderline reruns included
+    const start = performance.now();
+    const runs = context.cancelGroup.cancel();
+    // Testcases still compiling or waiting for the rerun queue haven't spawned into the group
     for (const state of context.state) {
-      state.process.stop();
-      state.interactorProcess.stop();
+      state.cancellationSource?.cancel();
     }
 
     // Wait for all to complete
@@ -1021,6 +1612,11 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     await Promise.all(donePromises);
 
     this._onDidChangeBackgroundTasks.fire();
+    if (runs > 0) {
+      getLogger("judge").info(
+        `Stopped ${runs} runs of ${file} in ${(performance.now() - start).toFixed(1)}ms`
+      );
+    }
   }
 
   async stopAllBackgroundTasks(): Promise<void> {
@@ -1065,6 +1661,12 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       case "TOGGLE_INTERACTIVE":
         this._toggleInteractive(uuid);
         break;
+      case "SUBTASK":
+        void this._editSubtask(uuid);
+        break;
+      case "LINE_COUNTS":
+        void this._lineCounts(uuid);
+        break;
     }
     this.requestSave();
   }
@@ -1098,6 +1700,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         timeLimit: context.timeLimit,
         memoryLimit: context.memoryLimit,
         testcases: this._serializeState(context.state),
+        subtasks: context.subtasks,
       };
     }
 
@@ -1153,6 +1756,11 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       skipped: testcase?.skipped ?? false,
       mode: testcase?.mode ?? mode,
       interactorSecret: new TextHandler(),
+      baselineElapsed: testcase?.baselineElapsed ?? 0,
+      subtask: testcase?.subtask ?? "",
+      threadCount: testcase?.threadCount ?? 0,
+      parallelism: testcase?.parallelism ?? 0,
+      borderlineRuns: testcase?.borderlineRuns ?? [],
       process: new Runnable(),
       interactorProcess: new Runnable(),
       interactorSecretResolver: undefined,
@@ -1431,6 +2039,8 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       void vscode.debug.stopDebugging(vscode.debug.activeDebugSession);
     }
 
+    // Also ends borderline reruns, which run outside the testcase's own process
+    testcase.cancellationSource?.cancel();
     testcase.process.stop();
     testcase.interactorProcess.stop();
   }
@@ -1549,6 +2159,61 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     }
   }
 
+  private async _editSubtask(uuid: string) {
+    const testcase = this._findTestcase(uuid);
+    if (!testcase) {
+      return;
+    }
+    const runtime = this._runtime;
+
+    const label = await vscode.window.showInputBox({
+      title: "Subtask",
+      prompt: "Subtask label for this testcase, empty for none",
+      value: testcase.subtask,
+    });
+    if (label === undefined) {
+      return;
+    }
+    testcase.subtask = label.trim();
+    super._postMessage({ type: "SET", uuid, property: "subtask", value: testcase.subtask });
+
+    if (testcase.subtask !== "") {
+      const subtask = runtime.subtasks[testcase.subtask] ?? { score: 0, dependencies: [] };
+      const score = await vscode.window.showInputBox({
+        title: `Subtask ${testcase.subtask}`,
+        prompt: "Points awarded when every testcase of the subtask passes",
+        value: String(subtask.score),
+        validateInput: (value) =>
+          Number(value) >= 0 ? undefined : "Enter a non-negative number of points",
+      });
+      const dependencies = score
+        ? await vscode.window.showInputBox({
+            title: `Subtask ${testcase.subtask}`,
+            prompt: "Subtasks that must pass first, separated by commas",
+            value: subtask.dependencies.join(", "),
+          })
+        : undefined;
+      runtime.subtasks[testcase.subtask] = {
+        score: score ? Number(score) : subtask.score,
+        dependencies:
+          dependencies === undefined
+            ? subtask.dependencies
+            : dependencies
+                .split(",")
+                .map((dependency) => dependency.trim())
+                .filter(Boolean),
+      };
+    }
+
+    // Drop definitions of subtasks no testcase belongs to anymore
+    for (const name of Object.keys(runtime.subtasks)) {
+      if (!runtime.state.some((other) => other.subtask === name)) {
+        delete runtime.subtasks[name];
+      }
+    }
+    this.requestSave();
+  }
+
   private _toggleInteractive(uuid: string) {
     const testcase = this._findTestcase(uuid);
     if (!testcase) {
@@ -1564,6 +2229,27 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     });
   }
 
+  private async _lineCounts(uuid: string) {
+    const testcase = this._findTestcase(uuid);
+    if (!testcase || !this._currentFile) {
+      return;
+    }
+    if (testcase.mode === "interactive") {
+      await vscode.window.showWarningMessage(
+        "Line counts are not supported for interactive testcases"
+      );
+      return;
+    }
+
+    const index = this._contexts.get(this._currentFile)?.state.indexOf(testcase) ?? -1;
+    await showLineCounts(
+      this._currentFile,
+      testcase.stdin.data,
+      `testcase #${index + 1}`,
+      this._context
+    );
+  }
+
   private _compare(uuid: string) {
     const testcase = this._findTestcase(uuid);
     if (!testcase) {
@@ -1717,7 +2403,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     if (testcase.mode === "interactive") {
       updateInteractiveTestcaseFromTermination(testcase);
     } else {
-      updateTestcaseFromTermination(testcase);
+      updateTestcaseAfterEdit(testcase);
     }
     super._postMessage({
       type: "SET",
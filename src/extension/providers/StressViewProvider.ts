@@ -1,16 +1,20 @@
 import * as vscode from "vscode";
 import * as v from "valibot";
 import * as crypto from "crypto";
+import { performance } from "node:perf_hooks";
 
 import type { Status } from "../../shared/enums";
 import BaseViewProvider from "./BaseViewProvider";
 import {
+  CancelGroup,
   compile,
   mapTestcaseTermination,
   Runnable,
+  startForkServer,
   terminationSeverityNumber,
   type Severity,
   type CompilationResult,
+  type ForkServer,
 } from "../utils/runtime";
 import {
   getFileRunSettings,
@@ -23,6 +27,11 @@ import {
   type WriteMode,
 } from "../utils/vscode";
 import { getLogger } from "../utils/logging";
+import { generateInput } from "../utils/generator";
+import { SizeTuner } from "../utils/sizeTuner";
+import { createHasher, type Hasher } from "../utils/hash";
+import { BoundedRelay } from "../utils/relay";
+import { isLagThrottled, onDidUpdateEventLoopLag, type LagStats } from "../utils/lagMonitor";
 import type JudgeViewProvider from "./JudgeViewProvider";
 import {
   AddMessageSchema,
@@ -34,7 +43,13 @@ import {
   ViewMessageSchema,
   type WebviewMessage,
 } from "../../shared/stress-messages";
-import { StressDataSchema, type StateId } from "../../shared/schemas";
+import {
+  StressDataSchema,
+  type GeneratorSpec,
+  type LanguageSettings,
+  type RuntimeProfile,
+  type StateId,
+} from "../../shared/schemas";
 
 const FileDataSchema = v.object({
   interactiveMode: v.fallback(v.boolean(), false),
@@ -49,6 +64,9 @@ const FileDataSchema = v.object({
 
 type FileData = v.InferOutput<typeof FileDataSchema>;
 
+const THROTTLED_ITERATION_DELAY_MS = 250;
+const DEFAULT_RELAY_BUFFER_KB = 1024;
+
 type State = {
   state: StateId;
   stdin: TextHandler;
@@ -58,9 +76,9 @@ type State = {
   shown: boolean;
   process: Runnable;
   errorHandler: (err: Error) => void;
-  stdoutDataHandler: (data: string) => void;
+  stdoutDataHandler: (data: Buffer) => void;
   stdoutEndHandler: () => void;
-  stderrDataHandler: (data: string) => void;
+  stderrDataHandler: (data: Buffer) => void;
   stderrEndHandler: () => void;
   closeHandler: (code: number | null) => void;
 };
@@ -69,8 +87,8 @@ interface StressContext {
   state: State[];
 
   // For interactive mode, combined stdout and stderr and maintains the order
-  combinedInteractiveStderr: string;
-  combinedInteractiveStdout: string;
+  combinedInteractiveStderr: Buffer[];
+  combinedInteractiveStdout: Buffer[];
 
   stopFlag: boolean;
   clearFlag: boolean;
@@ -85,12 +103,19 @@ interface StressContext {
   interactiveSecretPromise: Promise<void> | null;
   interactorSecretResolver?: () => void;
   donePromise: Promise<void> | null;
+  cancelGroup: CancelGroup; // the session's generator, solution, and judge runs
+  generatorRelay: BoundedRelay; // generator output into the solution and judge, per session
+  sizeTuner?: SizeTuner; // statistics of the last session with size hints
+  // Digests of this iteration's generator output and outcome, fed as they stream
+  inputHasher?: Hasher;
+  outcomeHasher?: Hasher;
 }
 
 export default class extends BaseViewProvider<typeof ProviderMessageSchema, WebviewMessage> {
   private _contexts: Map<string, StressContext> = new Map();
   private _onDidChangeBackgroundTasks = new vscode.EventEmitter<void>();
   readonly onDidChangeBackgroundTasks = this._onDidChangeBackgroundTasks.event;
+  private _lagShown = false;
 
   private get _currentContext(): StressContext | undefined {
     return this._currentFile ? this._contexts.get(this._currentFile) : undefined;
@@ -110,9 +135,13 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     const ctx = this._contexts.get(file);
     if (ctx && ctx.running) {
       ctx.stopFlag = true;
-      for (const state of ctx.state) {
-        state.process.stop();
-      }
+      const start = performance.now();
+      const runs = ctx.cancelGroup.cancel();
+      void ctx.donePromise?.then(() =>
+        getLogger("stress").info(
+          `Stopped ${runs} runs of ${file} in ${(performance.now() - start).toFixed(1)}ms`
+        )
+      );
     }
   }
 
@@ -180,7 +209,20 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     private _testcaseViewProvider: JudgeViewProvider
   ) {
     super("stress", context, ProviderMessageSchema);
-    this.onShow();
+    context.subscriptions.push(onDidUpdateEventLoopLag((stats) => this._postLag(stats)));
+  }
+
+  private _postLag(stats: LagStats) {
+    if (this._currentContext?.running) {
+      this._lagShown = true;
+      super._postMessage({
+        type: "LAG",
+        stats: { p99: stats.p99, max: stats.max, throttled: stats.throttled },
+      });
+    } else if (this._lagShown) {
+      this._lagShown = false;
+      super._postMessage({ type: "LAG", stats: null });
+    }
   }
 
   protected override _sendShowMessage(visible: boolean): void {
@@ -233,8 +275,8 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       stopFlag: false,
       clearFlag: false,
       running: false,
-      combinedInteractiveStderr: "",
-      combinedInteractiveStdout: "",
+      combinedInteractiveStderr: [],
+      combinedInteractiveStdout: [],
       interactiveMode: persistedState.interactiveMode,
       enforceGeneratorTime: persistedState.enforceGeneratorTime,
       enforceSolutionTime: persistedState.enforceSolutionTime,
@@ -244,6 +286,8 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       enforceJudgeMemory: persistedState.enforceJudgeMemory,
       interactiveSecretPromise: null,
       donePromise: null,
+      cancelGroup: new CancelGroup(),
+      generatorRelay: new BoundedRelay(DEFAULT_RELAY_BUFFER_KB * 1024),
     };
   }
 
@@ -326,6 +370,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
   }
 
   async run(): Promise<void> {
+    this._ensureCurrentFileLoaded();
     const ctx = this._currentContext;
     if (!ctx) return;
 
@@ -374,13 +419,28 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     const testcaseTimeLimit = config.get<number>("stressTestcaseTimeLimit")!;
     const testcaseMemoryLimit = config.get<number>("stressTestcaseMemoryLimit")!;
     const timeLimit = config.get<number>("stressTimeLimit")!;
+    const maxSize = config.get<number>("stressMaxSize", 0);
+    const relayBufferKb = config.get<number>("stressRelayBufferSize", DEFAULT_RELAY_BUFFER_KB);
 
     const solutionSettings = getFileRunSettings(file);
     if (!solutionSettings) {
       return;
     }
 
-    const generatorSettings = getFileRunSettings(solutionSettings.generatorFile!);
+    // A generator spec in run settings replaces the generator program
+    const generatorSpec = solutionSettings.generatorSpec;
+    let generatorRunCommand: string[] | undefined;
+    let generatorRuntimeProfile: RuntimeProfile | undefined;
+    let generatorLanguageSettings: LanguageSettings | undefined;
+    if (!generatorSpec) {
+      const generatorSettings = getFileRunSettings(solutionSettings.generatorFile!);
+      if (!generatorSettings) {
+        return;
+      }
+      generatorLanguageSettings = generatorSettings.languageSettings;
+      generatorRunCommand = generatorSettings.languageSettings.runCommand;
+      generatorRuntimeProfile = generatorSettings.languageSettings.runtimeProfile;
+    }
 
     let judgeSettings: FileRunSettings | null;
     if (ctx.interactiveMode) {
@@ -388,7 +448,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     } else {
       judgeSettings = getFileRunSettings(solutionSettings.goodSolutionFile!);
     }
-    if (!generatorSettings || !judgeSettings) {
+    if (!judgeSettings) {
       return;
     }
 
@@ -401,7 +461,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     if (!solutionSettings.languageSettings.runCommand) {
       logError(`No run command for ${file}`);
     }
-    if (!generatorSettings.languageSettings.runCommand) {
+    if (!generatorSpec && !generatorRunCommand) {
       logError(`No run command for ${solutionSettings.generatorFile}`);
     }
     if (!judgeSettings.languageSettings.runCommand) {
@@ -412,7 +472,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     }
     if (
       !solutionSettings.languageSettings.runCommand ||
-      !generatorSettings.languageSettings.runCommand ||
+      (!generatorSpec && !generatorRunCommand) ||
       !judgeSettings.languageSettings.runCommand
     ) {
       return;
@@ -458,7 +518,9 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     };
 
     const results = await Promise.all([
-      addCompileTask(generatorState, solutionSettings.generatorFile!),
+      generatorSpec
+        ? Promise.resolve({ code: 0, stdout: "", stderr: "" })
+        : addCompileTask(generatorState, solutionSettings.generatorFile!),
       addCompileTask(solutionState, file),
       ctx.interactiveMode
         ? addCompileTask(judgeState, solutionSettings.interactorFile!)
@@ -469,17 +531,39 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       return;
     }
 
+    // Fork servers only help compiled programs, and a managed runtime's flags depend on the
+    // limits, which can change between iterations
+    const cwd = solutionSettings.languageSettings.currentWorkingDirectory;
+    const startForkServerFor = (settings: LanguageSettings | undefined) =>
+      config.get<boolean>("forkServer", false) &&
+      settings?.compileCommand &&
+      !settings.runtimeProfile
+        ? startForkServer(settings.runCommand!, cwd)
+        : Promise.resolve(null);
+    const [generatorServer, solutionServer, judgeServer] = await Promise.all([
+      startForkServerFor(generatorLanguageSettings),
+      startForkServerFor(solutionSettings.languageSettings),
+      startForkServerFor(judgeSettings.languageSettings),
+    ]);
+    const forkServers = [generatorServer, solutionServer, judgeServer].filter(
+      (server): server is ForkServer => server !== null
+    );
+
     ctx.stopFlag = false;
     ctx.clearFlag = false;
     ctx.running = true;
+    const sizeTuner = maxSize > 0 ? new SizeTuner(maxSize) : undefined;
+    ctx.sizeTuner = sizeTuner;
+    const relay = new BoundedRelay(relayBufferKb * 1024);
+    ctx.generatorRelay = relay;
     this._onDidChangeBackgroundTasks.fire();
 
     const setupProcess = (state: State) => {
       state.process
         .on("error", state.errorHandler)
-        .on("stdout:data", state.stdoutDataHandler)
+        .on("stdout:bytes", state.stdoutDataHandler)
         .on("stdout:end", state.stdoutEndHandler)
-        .on("stderr:data", state.stderrDataHandler)
+        .on("stderr:bytes", state.stderrDataHandler)
         .on("stderr:end", state.stderrEndHandler)
         .on("close", state.closeHandler);
 
@@ -514,11 +598,15 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         state.stderr.reset();
       }
       if (ctx.interactiveMode) {
-        ctx.combinedInteractiveStderr = "";
-        ctx.combinedInteractiveStdout = "";
+        ctx.combinedInteractiveStderr = [];
+        ctx.combinedInteractiveStdout = [];
       }
 
       const seed = crypto.randomBytes(8).readBigUInt64BE();
+      const size = sizeTuner?.next();
+      ctx.inputHasher = sizeTuner ? createHasher() : undefined;
+      ctx.outcomeHasher = sizeTuner ? createHasher() : undefined;
+      const iterationStart = Date.now();
       ctx.interactiveSecretPromise = new Promise<void>((resolve) => {
         ctx.interactorSecretResolver = resolve;
       });
@@ -535,65 +623,111 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         judgeSettings.languageSettings.runCommand,
         judgeTimeArg,
         judgeMemArg,
-        solutionSettings.languageSettings.currentWorkingDirectory
+        solutionSettings.languageSettings.currentWorkingDirectory,
+        {
+          runtimeProfile: judgeSettings.languageSettings.runtimeProfile,
+          forkServer: judgeServer ?? undefined,
+          cancelGroup: ctx.cancelGroup,
+        }
       );
 
-      setupProcess(generatorState);
-      generatorState.process.on("spawn", () => {
-        generatorState.process.stdin?.write(`${seed}\n`);
-      });
-      generatorState.process.run(
-        generatorSettings.languageSettings.runCommand,
-        genTimeArg,
-        genMemArg,
-        solutionSettings.languageSettings.currentWorkingDirectory
-      );
+      if (!generatorSpec) {
+        setupProcess(generatorState);
+        generatorState.process.on("spawn", () => {
+          generatorState.process.stdin?.write(
+            size === undefined ? `${seed}\n` : `${seed}\n${size}\n`
+          );
+        });
+        generatorState.process.run(
+          generatorRunCommand!,
+          genTimeArg,
+          genMemArg,
+          solutionSettings.languageSettings.currentWorkingDirectory,
+          {
+            runtimeProfile: generatorRuntimeProfile,
+            forkServer: generatorServer ?? undefined,
+            cancelGroup: ctx.cancelGroup,
+          }
+        );
+      }
 
       setupProcess(solutionState);
       solutionState.process.run(
         solutionSettings.languageSettings.runCommand,
         solTimeArg,
         solMemArg,
-        solutionSettings.languageSettings.currentWorkingDirectory
+        solutionSettings.languageSettings.currentWorkingDirectory,
+        {
+          runtimeProfile: solutionSettings.languageSettings.runtimeProfile,
+          forkServer: solutionServer ?? undefined,
+          cancelGroup: ctx.cancelGroup,
+        }
       );
 
-      const generatorPromise = executionPromise(generatorState);
+      const generatorPromise = generatorSpec
+        ? this._runGeneratorSpec(file, generatorSpec, seed, size)
+        : executionPromise(generatorState);
       const solutionPromise = executionPromise(solutionState);
       const judgePromise = executionPromise(judgeState);
 
       const severities = await Promise.all([generatorPromise, solutionPromise, judgePromise]);
       const maxSeverity = Math.max(...severities) as Severity;
 
+      let stop = false;
       if (ctx.interactiveMode) {
         if (maxSeverity === 0) {
           // All finished successfully. Do nothing
         } else if (maxSeverity === 1) {
           // Stopped
-          break;
+          stop = true;
         } else if (
           solutionState.process.exitCode === null ||
           judgeState.process.exitCode === null
         ) {
           // Crashed
-          break;
+          stop = true;
         } else if (judgeState.process.exitCode !== 0) {
           // WA
           judgeState.status = "NA";
           solutionState.status = "WA";
-          break;
+          stop = true;
         }
       } else {
         if (maxSeverity > 0) {
-          break;
-        } else if (solutionState.stdout.data !== judgeState.stdout.data) {
+          stop = true;
+        } else if (!solutionState.stdout.bytes.equals(judgeState.stdout.bytes)) {
           solutionState.status = "WA";
-          break;
+          stop = true;
         }
       }
 
-      await new Promise<void>((resolve) => setTimeout(() => resolve(), delayBetweenTestcases));
+      if (sizeTuner && size !== undefined && maxSeverity !== 1) {
+        sizeTuner.record(
+          size,
+          Date.now() - iterationStart,
+          ctx.inputHasher!.digest(),
+          ctx.outcomeHasher!.digest(),
+          stop
+        );
+      }
+      if (stop) {
+        break;
+      }
+
+      // Back off while the extension host lags, so relaying output doesn't freeze the editor
+      const delay = isLagThrottled()
+        ? Math.max(delayBetweenTestcases, THROTTLED_ITERATION_DELAY_MS)
+        : delayBetweenTestcases;
+      await new Promise<void>((resolve) => setTimeout(() => resolve(), delay));
     }
     ctx.running = false;
+    for (const server of forkServers) {
+      server.close();
+    }
+    const { peakQueuedBytes, pauses } = relay.stats;
+    getLogger("stress").info(
+      `Generator relay peaked at ${Math.round(peakQueuedBytes / 1024)} KiB queued, paused ${pauses} times`
+    );
 
     for (const state of ctx.state) {
       super._postMessage(
@@ -621,6 +755,44 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     this._onDidChangeBackgroundTasks.fire();
   }
 
+  // Generates the input in process and relays it exactly like generator program output
+  private async _runGeneratorSpec(
+    file: string,
+    spec: GeneratorSpec,
+    seed: bigint,
+    size: number | undefined
+  ): Promise<Severity> {
+    const ctx = this._contexts.get(file)!;
+    const generatorState = ctx.state.find((s) => s.state === "Generator")!;
+    const others = ctx.state.filter((s) => s !== generatorState);
+
+    let input: string;
+    try {
+      input = generateInput(spec, seed, size);
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      getLogger("stress").error(`Generator spec failed for seed ${seed}: ${errorMessage}`);
+      generatorState.stderr.write(errorMessage, "final");
+      generatorState.status = "RE";
+      for (const state of others) {
+        await state.process.spawned;
+        state.process.stop();
+      }
+      return terminationSeverityNumber("error");
+    }
+
+    await Promise.all(others.map((state) => state.process.spawned));
+    // Fed in chunks so a large input waits for the consumers like a generator program would
+    const bytes = Buffer.from(input);
+    const chunkSize = ctx.generatorRelay.highWaterMark;
+    for (let offset = 0; offset < bytes.length; offset += chunkSize) {
+      await this._onStdoutData(file, "Generator", bytes.subarray(offset, offset + chunkSize));
+    }
+    this._onStdoutEnd(file, "Generator");
+    generatorState.status = "NA";
+    return terminationSeverityNumber("exit");
+  }
+
   private _view({ id, stdio }: v.InferOutput<typeof ViewMessageSchema>) {
     const ctx = this._currentContext;
     if (!ctx) return;
@@ -711,8 +883,8 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
         this._testcaseViewProvider.addTestcaseToFile(resolvedFile, {
           uuid: crypto.randomUUID(),
           stdin: "",
-          stderr: ctx.combinedInteractiveStderr,
-          stdout: ctx.combinedInteractiveStdout,
+          stderr: Buffer.concat(ctx.combinedInteractiveStderr).toString(),
+          stdout: Buffer.concat(ctx.combinedInteractiveStdout).toString(),
           acceptedStdout: "",
           elapsed: currentState?.process.elapsed ?? 0,
           memoryBytes: currentState?.process.maxMemoryBytes ?? 0,
@@ -793,6 +965,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
   }
 
   clear() {
+    this._ensureCurrentFileLoaded();
     const ctx = this._currentContext;
     if (!ctx) return;
 
@@ -951,7 +1124,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     }
   }
 
-  private async _onStdoutData(file: string, stateId: StateId, data: string) {
+  private async _onStdoutData(file: string, stateId: StateId, data: Buffer) {
     const ctx = this._contexts.get(file);
     if (!ctx) {
       return;
@@ -963,30 +1136,37 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
 
     if (stateId === "Generator") {
       state.stdout.write(data, writeMode);
+      ctx.inputHasher?.update(data);
 
       const solutionState = ctx.state.find((s) => s.state === "Solution")!;
       const judgeState = ctx.state.find((s) => s.state === "Judge")!;
+      const consumers = ctx.interactiveMode ? [judgeState] : [solutionState, judgeState];
+      // A generator spec has no process output to pause, its caller awaits instead
+      const relayed = ctx.generatorRelay.write(
+        state.process.stdout,
+        consumers.map((s) => s.process.stdin),
+        data
+      );
       if (ctx.interactiveMode) {
-        judgeState.process.stdin?.write(data);
         ctx.interactorSecretResolver?.();
-      } else {
-        solutionState.process.stdin?.write(data);
-        judgeState.process.stdin?.write(data);
       }
+      await relayed;
     } else if (stateId === "Solution") {
       state.stdout.write(data, writeMode);
       if (ctx.interactiveMode) {
         await ctx.interactiveSecretPromise; // wait for secret to be sent first
         const judgeState = ctx.state.find((s) => s.state === "Judge")!;
         judgeState.process.stdin?.write(data);
-        ctx.combinedInteractiveStdout += data;
+        ctx.combinedInteractiveStdout.push(data);
       }
+      ctx.outcomeHasher?.update(data);
     } else if (stateId === "Judge") {
       state.stdout.write(data, writeMode);
       if (ctx.interactiveMode) {
         const solutionState = ctx.state.find((s) => s.state === "Solution")!;
         solutionState.process.stdin?.write(data);
-        ctx.combinedInteractiveStdout += data;
+        ctx.combinedInteractiveStdout.push(data);
+        ctx.outcomeHasher?.update(data);
       }
     }
   }
@@ -1000,7 +1180,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
     }
   }
 
-  private _onStderrData(file: string, stateId: StateId, data: string) {
+  private _onStderrData(file: string, stateId: StateId, data: Buffer) {
     const ctx = this._contexts.get(file);
     if (!ctx) return;
     const state = ctx.state.find((s) => s.state === stateId);
@@ -1008,7 +1188,7 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
       state.stderr.write(data, "batch");
     }
     if (ctx.interactiveMode && (stateId === "Solution" || stateId === "Judge")) {
-      ctx.combinedInteractiveStderr += data;
+      ctx.combinedInteractiveStderr.push(data);
     }
   }
 
@@ -1039,4 +1219,16 @@ export default class extends BaseViewProvider<typeof ProviderMessageSchema, Webv
   toggleWebviewSettings() {
     super._postMessage({ type: "SETTINGS_TOGGLE" });
   }
+
+  showSizeReport() {
+    const file = this._currentFile;
+    const sizeTuner = this._currentContext?.sizeTuner;
+    if (!file || !sizeTuner) {
+      void vscode.window.showInformationMessage(
+        "No size statistics yet. Set stressMaxSize and run the Stress Tester first"
+      );
+      return;
+    }
+    void openInNewEditor(sizeTuner.formatReport(file), "Stress Sizes.md", file);
+  }
 }
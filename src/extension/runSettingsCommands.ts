@@ -62,12 +62,14 @@ const languageTemplates: Record<string, object> = {
   PyPy: {
     ".py": {
       runCommand: ["pypy3", "${file}"],
+      runtimeProfile: "pypy",
     },
   },
   Java: {
     ".java": {
       compileCommand: ["javac", "-g", "${file}"],
       runCommand: ["java", "-cp", "${fileDirname}", "${fileBasenameNoExtension}"],
+      runtimeProfile: "jvm",
       ...javaAttachDebugConfig,
     },
   },
@@ -97,6 +99,7 @@ const languageTemplates: Record<string, object> = {
   JavaScript: {
     ".js": {
       runCommand: ["node", "${file}"],
+      runtimeProfile: "node",
       debugCommand: ["node", "--inspect-brk=localhost:${debugPort}", "${file}"],
       debugAttachConfig: "JavaScript: Attach",
     },
@@ -104,6 +107,7 @@ const languageTemplates: Record<string, object> = {
   TypeScript: {
     ".ts": {
       runCommand: ["node", "--experimental-transform-types", "${file}"],
+      runtimeProfile: "node",
       debugCommand: [
         "node",
         "--experimental-transform-types",
@@ -162,6 +166,7 @@ const languageTemplates: Record<string, object> = {
         "${fileDirname}/${fileBasenameNoExtension}.jar",
       ],
       runCommand: ["java", "-jar", "${fileDirname}/${fileBasenameNoExtension}.jar"],
+      runtimeProfile: "jvm",
     },
   },
 };
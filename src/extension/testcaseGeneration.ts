@@ -0,0 +1,257 @@
+import * as crypto from "node:crypto";
+import os from "node:os";
+import * as path from "node:path";
+import * as vscode from "vscode";
+
+import type JudgeViewProvider from "./providers/JudgeViewProvider";
+import { generateInput } from "./utils/generator";
+import { sampleSize } from "./utils/sizeTuner";
+import { compile, getTimeLimitMode, Runnable, type RunTermination } from "./utils/runtime";
+import { getFileRunSettings, TextHandler } from "./utils/vscode";
+import { hashBytes } from "./utils/hash";
+import { getLogger } from "./utils/logging";
+import { waitForWorkerSlot } from "./utils/lagMonitor";
+import type { GeneratorSpec, LanguageSettings } from "../shared/schemas";
+
+type RunResult = {
+  stdout: string;
+  termination: RunTermination;
+};
+
+type GenerationLimits = {
+  timeLimit: number;
+  memoryLimit: number;
+  maxSize: number; // largest size hint for the generator, 0 for none
+};
+
+type GeneratedTestcase = {
+  stdin: string;
+  acceptedStdout: string;
+};
+
+type GenerationSummary = {
+  testcases: GeneratedTestcase[];
+  duplicates: number;
+  failures: number;
+};
+
+async function runWithInput(
+  settings: LanguageSettings,
+  input: string,
+  limits: GenerationLimits
+): Promise<RunResult> {
+  const runnable = new Runnable();
+  const stdout = new TextHandler();
+  runnable
+    .on("spawn", () => runnable.stdin?.end(input))
+    .on("stdout:bytes", (data: Buffer) => stdout.write(data, "batch"))
+    .on("stdout:end", () => stdout.write("", "final"))
+    .run(
+      settings.runCommand!,
+      limits.timeLimit,
+      limits.memoryLimit,
+      settings.currentWorkingDirectory,
+      { timeLimitMode: getTimeLimitMode(), runtimeProfile: settings.runtimeProfile }
+    );
+  await runnable.done;
+  void runnable.dispose();
+  return { stdout: stdout.data, termination: runnable.termination };
+}
+
+/**
+ * Runs the generator over `count` random seeds and the good solution over each distinct
+ * input, several seeds at a time. Generators get the same stdin as in the Stress Tester, the
+ * seed and, with `maxSize` set, a size hint sampled across its bands. Inputs are deduplicated
+ * by hash before the good solution runs, so repeated small inputs cost one generator run
+ * each.
+ */
+async function generateTestcases(
+  count: number,
+  generator: GeneratorSpec | LanguageSettings,
+  goodSolution: LanguageSettings,
+  limits: GenerationLimits,
+  progress: vscode.Progress<{ message?: string; increment?: number }>,
+  token: vscode.CancellationToken
+): Promise<GenerationSummary> {
+  const logger = getLogger("stress");
+  const seeds = Array.from({ length: count }, () => crypto.randomBytes(8).readBigUInt64BE());
+  const results: (GeneratedTestcase | undefined)[] = new Array(count);
+  const seen = new Set<string>();
+  let duplicates = 0;
+  let failures = 0;
+  let next = 0;
+
+  const parallelism = Math.max(Math.min(os.cpus().length, count), 1);
+  const worker = async (slot: number) => {
+    while (next < count && !token.isCancellationRequested) {
+      await waitForWorkerSlot(slot, parallelism, token);
+      if (next >= count || token.isCancellationRequested) {
+        break;
+      }
+      const index = next++;
+      const seed = seeds[index];
+      const size = limits.maxSize > 0 ? sampleSize(limits.maxSize) : undefined;
+      progress.report({ message: `${index + 1} of ${count}`, increment: 100 / count });
+
+      let input: string;
+      if (Array.isArray(generator)) {
+        try {
+          input = generateInput(generator, seed, size);
+        } catch (error) {
+          const errorMessage = error instanceof Error ? error.message : String(error);
+          logger.error(`Generator spec failed for seed ${seed} size ${size}: ${errorMessage}`);
+          failures++;
+          continue;
+        }
+      } else {
+        const generatorInput = size === undefined ? `${seed}\n` : `${seed}\n${size}\n`;
+        const result = await runWithInput(generator, generatorInput, limits);
+        if (result.termination !== "exit") {
+          logger.error(
+            `Generator failed for seed ${seed} size ${size} (termination=${result.termination})`
+          );
+          failures++;
+          continue;
+        }
+        input = result.stdout;
+      }
+
+      const inputHash = hashBytes(input);
+      if (seen.has(inputHash)) {
+        duplicates++;
+        continue;
+      }
+      seen.add(inputHash);
+
+      const answer = await runWithInput(goodSolution, input, limits);
+      if (answer.termination !== "exit") {
+        logger.error(`Good solution failed for seed ${seed} (termination=${answer.termination})`);
+        failures++;
+        continue;
+      }
+      results[index] = { stdin: input, acceptedStdout: answer.stdout };
+    }
+  };
+
+  await Promise.all(Array.from({ length: parallelism }, (_, slot) => worker(slot)));
+
+  // Keep seed order so the inserted testcases don't depend on which worker finished first
+  return {
+    testcases: results.filter((testcase): testcase is GeneratedTestcase => !!testcase),
+    duplicates,
+    failures,
+  };
+}
+
+async function compileOrReport(file: string, context: vscode.ExtensionContext): Promise<boolean> {
+  const result = await compile(file, context);
+  if (!result || result.code !== 0) {
+    await vscode.window.showErrorMessage(`Failed to compile ${path.basename(file)}`);
+    return false;
+  }
+  return true;
+}
+
+async function generateTestcasesForFile(
+  file: string,
+  judgeViewProvider: JudgeViewProvider,
+  context: vscode.ExtensionContext
+): Promise<void> {
+  const settings = getFileRunSettings(file);
+  if (!settings) {
+    return;
+  }
+
+  const goodSolutionSettings = getFileRunSettings(settings.goodSolutionFile!);
+  if (!goodSolutionSettings?.languageSettings.runCommand) {
+    await vscode.window.showErrorMessage(`No run command for ${settings.goodSolutionFile}`);
+    return;
+  }
+  let generator: GeneratorSpec | LanguageSettings;
+  if (settings.generatorSpec) {
+    generator = settings.generatorSpec;
+  } else {
+    const generatorSettings = getFileRunSettings(settings.generatorFile!);
+    if (!generatorSettings?.languageSettings.runCommand) {
+      await vscode.window.showErrorMessage(`No run command for ${settings.generatorFile}`);
+      return;
+    }
+    generator = generatorSettings.languageSettings;
+  }
+
+  const countText = await vscode.window.showInputBox({
+    title: "Generate Testcases",
+    prompt: "Number of testcases to generate",
+    value: "20",
+    validateInput: (value) => {
+      const count = Number(value);
+      return Number.isInteger(count) && count > 0 ? undefined : "Enter a positive integer";
+    },
+  });
+  if (!countText) {
+    return;
+  }
+  const count = Number(countText);
+
+  const compiled = await Promise.all([
+    settings.generatorSpec ? true : compileOrReport(settings.generatorFile!, context),
+    compileOrReport(settings.goodSolutionFile!, context),
+  ]);
+  if (compiled.includes(false)) {
+    return;
+  }
+
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  const limits = {
+    timeLimit: config.get<number>("stressTestcaseTimeLimit", 0),
+    memoryLimit: config.get<number>("stressTestcaseMemoryLimit", 0),
+    maxSize: config.get<number>("stressMaxSize", 0),
+  };
+  const summary = await vscode.window.withProgress(
+    {
+      location: vscode.ProgressLocation.Notification,
+      title: "Generating testcases",
+      cancellable: true,
+    },
+    (progress, token) =>
+      generateTestcases(
+        count,
+        generator,
+        goodSolutionSettings.languageSettings,
+        limits,
+        progress,
+        token
+      )
+  );
+
+  const added = judgeViewProvider.appendImportedTestcasesForFile(file, summary.testcases);
+  getLogger("stress").info(
+    `Generated ${added} testcases for ${file} (${summary.duplicates} duplicates, ${summary.failures} failures)`
+  );
+  const details = [
+    summary.duplicates > 0 ? `${summary.duplicates} duplicate inputs skipped` : "",
+    summary.failures > 0 ? `${summary.failures} failed runs, see logs` : "",
+  ].filter(Boolean);
+  const message = `Added ${added} testcases${details.length > 0 ? ` (${details.join(", ")})` : ""}`;
+  if (summary.failures > 0) {
+    await vscode.window.showWarningMessage(message);
+  } else {
+    await vscode.window.showInformationMessage(message);
+  }
+}
+
+export function registerGenerationCommands(
+  context: vscode.ExtensionContext,
+  judgeViewProvider: JudgeViewProvider
+): void {
+  context.subscriptions.push(
+    vscode.commands.registerCommand("fastolympiccoding.generateTestcases", async () => {
+      const file = judgeViewProvider.getCurrentFile();
+      if (!file) {
+        await vscode.window.showWarningMessage("Open a file in Judge before generating testcases");
+        return;
+      }
+      await generateTestcasesForFile(file, judgeViewProvider, context);
+    })
+  );
+}
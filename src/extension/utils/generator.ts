@@ -0,0 +1,219 @@
+import type { GeneratorSpec, GeneratorStatement } from "../../shared/schemas";
+
+/**
+ * xoshiro128** seeded through splitmix32. Fast, small state, and reproducible from the
+ * 64-bit stress seed, so a failing input can be regenerated from its seed alone.
+ */
+class Random {
+  private _s = new Uint32Array(4);
+
+  constructor(seed: bigint) {
+    let x =
+      Number(BigInt.asUintN(32, seed)) ^
+      Math.imul(Number(BigInt.asUintN(32, seed >> 32n)), 0x9e3779b9);
+    for (let i = 0; i < 4; i++) {
+      x = (x + 0x9e3779b9) | 0;
+      let z = x;
+      z = Math.imul(z ^ (z >>> 16), 0x85ebca6b);
+      z = Math.imul(z ^ (z >>> 13), 0xc2b2ae35);
+      this._s[i] = z ^ (z >>> 16);
+    }
+  }
+
+  next(): number {
+    const s = this._s;
+    const result = Math.imul(rotl(Math.imul(s[1], 5), 7), 9) >>> 0;
+    const t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+    return result;
+  }
+
+  // Uniform in [0, 1) with 53 bits of precision
+  uniform(): number {
+    return ((this.next() >>> 5) * 67108864 + (this.next() >>> 6)) / 9007199254740992;
+  }
+
+  int(min: number, max: number): number {
+    return min + Math.floor(this.uniform() * (max - min + 1));
+  }
+
+  shuffle<T>(values: T[]): T[] {
+    for (let i = values.length - 1; i > 0; i--) {
+      const j = this.int(0, i);
+      [values[i], values[j]] = [values[j], values[i]];
+    }
+    return values;
+  }
+}
+
+function rotl(x: number, k: number): number {
+  return (x << k) | (x >>> (32 - k));
+}
+
+type Scope = Map<string, number>;
+type Value = number | string;
+
+function resolve(value: Value, scope: Scope): number {
+  if (typeof value === "number") {
+    return value;
+  }
+  const bound = scope.get(value);
+  if (bound === undefined) {
+    throw new Error(`Generator value "${value}" is not defined by an earlier ints statement`);
+  }
+  return bound;
+}
+
+function resolveRange([min, max]: [Value, Value], scope: Scope): [number, number] {
+  const low = resolve(min, scope);
+  const high = resolve(max, scope);
+  if (!Number.isSafeInteger(low) || !Number.isSafeInteger(high) || low > high) {
+    throw new Error(`Invalid generator range [${low}, ${high}]`);
+  }
+  return [low, high];
+}
+
+function resolveCount(value: Value, scope: Scope, what: string): number {
+  const count = resolve(value, scope);
+  if (!Number.isSafeInteger(count) || count < 0) {
+    throw new Error(`Invalid ${what} ${count}`);
+  }
+  return count;
+}
+
+function distinctValues(random: Random, length: number, min: number, max: number): number[] {
+  const span = max - min + 1;
+  if (length > span) {
+    throw new Error(`Cannot pick ${length} distinct values from [${min}, ${max}]`);
+  }
+  // Dense picks shuffle the whole range, sparse picks reject duplicates
+  if (span <= 4 * length) {
+    const values = Array.from({ length: span }, (_, i) => min + i);
+    return random.shuffle(values).slice(0, length);
+  }
+  const seen = new Set<number>();
+  while (seen.size < length) {
+    seen.add(random.int(min, max));
+  }
+  return [...seen];
+}
+
+function edgeLine(
+  random: Random,
+  u: number,
+  v: number,
+  weights: [number, number] | undefined
+): string {
+  const [a, b] = random.int(0, 1) === 0 ? [u, v] : [v, u];
+  return weights ? `${a} ${b} ${random.int(...weights)}` : `${a} ${b}`;
+}
+
+// Random parent for every vertex, then relabelled so the root and shape aren't predictable
+function treeEdges(random: Random, vertices: number): [number, number][] {
+  const labels = random.shuffle(Array.from({ length: vertices }, (_, i) => i + 1));
+  const edges: [number, number][] = [];
+  for (let i = 1; i < vertices; i++) {
+    edges.push([labels[random.int(0, i - 1)], labels[i]]);
+  }
+  return random.shuffle(edges);
+}
+
+function graphEdges(
+  random: Random,
+  vertices: number,
+  edges: number,
+  connected: boolean
+): [number, number][] {
+  const maxEdges = (vertices * (vertices - 1)) / 2;
+  if (edges > maxEdges || (connected && vertices > 0 && edges < vertices - 1)) {
+    throw new Error(`Cannot build a simple graph with ${vertices} vertices and ${edges} edges`);
+  }
+
+  const result: [number, number][] = connected ? treeEdges(random, vertices) : [];
+  const seen = new Set(result.map(([u, v]) => Math.min(u, v) * (vertices + 1) + Math.max(u, v)));
+  while (result.length < edges) {
+    const u = random.int(1, vertices);
+    const v = random.int(1, vertices);
+    const key = Math.min(u, v) * (vertices + 1) + Math.max(u, v);
+    if (u !== v && !seen.has(key)) {
+      seen.add(key);
+      result.push([u, v]);
+    }
+  }
+  return random.shuffle(result);
+}
+
+function evaluate(
+  statements: GeneratorStatement[],
+  random: Random,
+  scope: Scope,
+  lines: string[]
+): void {
+  for (const statement of statements) {
+    if ("ints" in statement) {
+      const values = Object.entries(statement.ints).map(([name, range]) => {
+        const value = random.int(...resolveRange(range, scope));
+        scope.set(name, value);
+        return value;
+      });
+      lines.push(values.join(" "));
+    } else if ("array" in statement) {
+      const { length, range, distinct, sorted } = statement.array;
+      const count = resolveCount(length, scope, "array length");
+      const [min, max] = resolveRange(range, scope);
+      const values = distinct
+        ? distinctValues(random, count, min, max)
+        : Array.from({ length: count }, () => random.int(min, max));
+      if (sorted) {
+        values.sort((a, b) => a - b);
+      }
+      lines.push(values.join(" "));
+    } else if ("permutation" in statement) {
+      const count = resolveCount(statement.permutation, scope, "permutation length");
+      lines.push(random.shuffle(Array.from({ length: count }, (_, i) => i + 1)).join(" "));
+    } else if ("tree" in statement) {
+      const vertices = resolveCount(statement.tree.vertices, scope, "vertex count");
+      const weights = statement.tree.weights && resolveRange(statement.tree.weights, scope);
+      for (const [u, v] of treeEdges(random, vertices)) {
+        lines.push(edgeLine(random, u, v, weights));
+      }
+    } else if ("graph" in statement) {
+      const vertices = resolveCount(statement.graph.vertices, scope, "vertex count");
+      const edges = resolveCount(statement.graph.edges, scope, "edge count");
+      const weights = statement.graph.weights && resolveRange(statement.graph.weights, scope);
+      for (const [u, v] of graphEdges(random, vertices, edges, !!statement.graph.connected)) {
+        lines.push(edgeLine(random, u, v, weights));
+      }
+    } else if ("string" in statement) {
+      const { length, alphabet } = statement.string;
+      const count = resolveCount(length, scope, "string length");
+      let value = "";
+      for (let i = 0; i < count; i++) {
+        value += alphabet[random.int(0, alphabet.length - 1)];
+      }
+      lines.push(value);
+    } else {
+      const count = resolveCount(statement.repeat.count, scope, "repeat count");
+      for (let i = 0; i < count; i++) {
+        evaluate(statement.repeat.body, random, scope, lines);
+      }
+    }
+  }
+}
+
+/**
+ * Evaluates a declarative generator spec from run settings. The same seed always produces
+ * the same input. The stress size hint, if any, is available to the spec as `size`.
+ * Throws if the spec can't be satisfied, e.g. too many distinct values.
+ */
+export function generateInput(spec: GeneratorSpec, seed: bigint, size?: number): string {
+  const lines: string[] = [];
+  const scope: Scope = size === undefined ? new Map() : new Map([["size", size]]);
+  evaluate(spec, new Random(seed), scope, lines);
+  return lines.join("\n") + "\n";
+}
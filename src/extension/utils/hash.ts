@@ -0,0 +1,102 @@
+import * as crypto from "node:crypto";
+import * as fs from "node:fs";
+import * as path from "node:path";
+import { createRequire } from "node:module";
+
+import { getLogger } from "./logging";
+
+export type Hasher = {
+  update: (data: Buffer | string) => void;
+  digest: () => string; // doesn't end the hash, more data can follow
+};
+
+type HashAddon = {
+  hash: (data: Buffer | string) => string;
+  hashFile: (file: string | number) => Promise<string>;
+  createHasher: () => Hasher;
+};
+
+let hashAddon: HashAddon | null = null;
+let hashAddonLoaded = false;
+
+function getNativeHash(): HashAddon | null {
+  if (hashAddonLoaded) {
+    return hashAddon;
+  }
+
+  hashAddonLoaded = true;
+  const addonPath = path.join(__dirname, "hash.node");
+  try {
+    if (!fs.existsSync(addonPath)) {
+      getLogger("runtime").warn(`Hash addon not found at ${addonPath}, using MD5`);
+      return null;
+    }
+    hashAddon = createRequire(__filename)(addonPath) as HashAddon;
+  } catch (err) {
+    getLogger("runtime").warn(
+      `Hash addon unavailable, using MD5: ${err instanceof Error ? err.message : String(err)}`
+    );
+  }
+  return hashAddon;
+}
+
+// The digests below are XXH64 from the native addon, or MD5 where it's missing. They are only
+// meant for identity within one extension host, so never persist them.
+
+/**
+ * Hashes data already in memory, like a program's stdin or output.
+ */
+export function hashBytes(data: Buffer | string): string {
+  const native = getNativeHash();
+  if (native) {
+    return native.hash(data);
+  }
+  return crypto.createHash("md5").update(data).digest("hex");
+}
+
+/**
+ * Hashes a file on the threadpool without reading it into the extension host. Takes a path,
+ * or a file descriptor (Linux and macOS) such as a memfd, which is read from its start.
+ */
+export async function hashFile(file: string | number): Promise<string> {
+  const native = getNativeHash();
+  if (native) {
+    return native.hashFile(file);
+  }
+  const content =
+    typeof file === "number"
+      ? await readFileDescriptor(file)
+      : await fs.promises.readFile(file);
+  return crypto.createHash("md5").update(content).digest("hex");
+}
+
+/**
+ * Starts an incremental hash for data that arrives in chunks. Gives the same digest as
+ * `hashBytes` over the concatenated chunks.
+ */
+export function createHasher(): Hasher {
+  const native = getNativeHash();
+  if (native) {
+    return native.createHasher();
+  }
+  const md5 = crypto.createHash("md5");
+  return {
+    update: (data) => md5.update(data),
+    digest: () => md5.copy().digest("hex"),
+  };
+}
+
+async function readFileDescriptor(fd: number): Promise<Buffer> {
+  const chunks: Buffer[] = [];
+  for (let position = 0; ; ) {
+    const buffer = Buffer.alloc(1 << 20);
+    const bytesRead = await new Promise<number>((resolve, reject) =>
+      fs.read(fd, buffer, 0, buffer.length, position, (err, n) => (err ? reject(err) : resolve(n)))
+    );
+    if (bytesRead === 0) {
+      return Buffer.concat(chunks);
+    }
+    chunks.push(buffer.subarray(0, bytesRead));
+    position += bytesRead;
+  }
+}
@@ -0,0 +1,109 @@
+import { monitorEventLoopDelay, type IntervalHistogram } from "node:perf_hooks";
+import * as vscode from "vscode";
+
+import { getLogger } from "./logging";
+
+export type LagStats = {
+  mean: number; // ms, over the last window
+  p99: number;
+  max: number;
+  throttled: boolean;
+};
+
+const WINDOW_MS = 1000;
+
+let histogram: IntervalHistogram | undefined;
+let stats: LagStats = { mean: 0, p99: 0, max: 0, throttled: false };
+let throttledSince = 0;
+const onDidUpdateEmitter = new vscode.EventEmitter<LagStats>();
+
+/**
+ * Fires once per window with the event loop delay of the extension host over that window.
+ */
+export const onDidUpdateEventLoopLag = onDidUpdateEmitter.event;
+
+function getThreshold(): number {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return config.get<number>("eventLoopLagThreshold", 100);
+}
+
+function sample() {
+  const h = histogram!;
+  const next: LagStats = {
+    mean: h.count > 0 ? h.mean / 1e6 : 0,
+    p99: h.count > 0 ? h.percentile(99) / 1e6 : 0,
+    max: h.count > 0 ? h.max / 1e6 : 0,
+    throttled: stats.throttled,
+  };
+  h.reset();
+
+  // Hysteresis, so output that hovers around the threshold doesn't flip the mode every window
+  const threshold = getThreshold();
+  const logger = getLogger("runtime");
+  if (threshold > 0 && !stats.throttled && next.p99 > threshold) {
+    next.throttled = true;
+    throttledSince = Date.now();
+    logger.warn(
+      `Event loop lag p99 ${next.p99.toFixed(0)}ms exceeds ${threshold}ms, throttling output updates and parallelism`
+    );
+  } else if (stats.throttled && (threshold <= 0 || next.p99 < threshold / 2)) {
+    next.throttled = false;
+    logger.info(
+      `Event loop lag p99 back to ${next.p99.toFixed(0)}ms after ${Date.now() - throttledSince}ms, throttling lifted`
+    );
+  }
+  logger.trace(
+    `Event loop lag mean ${next.mean.toFixed(1)}ms, p99 ${next.p99.toFixed(1)}ms, max ${next.max.toFixed(1)}ms`
+  );
+
+  stats = next;
+  onDidUpdateEmitter.fire(stats);
+}
+
+/**
+ * Starts sampling the extension host's event loop delay. Must be called during activation.
+ */
+export function initLagMonitor(context: vscode.ExtensionContext): void {
+  if (histogram) {
+    return;
+  }
+
+  histogram = monitorEventLoopDelay({ resolution: 20 });
+  histogram.enable();
+  const interval = setInterval(sample, WINDOW_MS);
+  context.subscriptions.push(onDidUpdateEmitter, {
+    dispose: () => {
+      clearInterval(interval);
+      histogram?.disable();
+      histogram = undefined;
+    },
+  });
+}
+
+export function getEventLoopLag(): LagStats {
+  return stats;
+}
+
+// Whether output relaying and parallel work should back off to let the editor catch up
+export function isLagThrottled(): boolean {
+  return stats.throttled;
+}
+
+// Half the workers (at least one) keep running while throttled
+export function getAllowedWorkers(workers: number): number {
+  return stats.throttled ? Math.max(Math.floor(workers / 2), 1) : workers;
+}
+
+/**
+ * Parks a worker while its index is over the throttled worker count. Workers below it
+ * are never delayed.
+ */
+export async function waitForWorkerSlot(
+  index: number,
+  workers: number,
+  token?: vscode.CancellationToken
+): Promise<void> {
+  while (index >= getAllowedWorkers(workers) && !token?.isCancellationRequested) {
+    await new Promise<void>((resolve) => setTimeout(resolve, WINDOW_MS));
+  }
+}
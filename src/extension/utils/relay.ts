@@ -0,0 +1,73 @@
+import type * as net from "node:net";
+
+export type RelayStats = {
+  peakQueuedBytes: number; // most bytes waiting in one consumer's stdin at once
+  pauses: number; // times the source was paused for a slow consumer
+};
+
+/**
+ * Copies one program's output into the stdin of others without letting input they haven't
+ * read yet pile up in the extension host. Writes never block. Instead, the source is paused
+ * once a consumer has more than `highWaterMark` bytes queued and resumed when every such
+ * consumer has drained or closed.
+ *
+ * `highWaterMark` must be at least a socket's own (16 KiB), so that a consumer over it
+ * always emits `drain`.
+ */
+export class BoundedRelay {
+  private _waiting: Promise<void> | null = null;
+  private _stats: RelayStats = { peakQueuedBytes: 0, pauses: 0 };
+
+  constructor(readonly highWaterMark: number) {}
+
+  get stats(): RelayStats {
+    return this._stats;
+  }
+
+  /**
+   * Writes `data` to every open consumer. The returned promise settles once they have all
+   * caught up, so callers producing data themselves can await it between chunks.
+   */
+  write(
+    source: net.Socket | undefined,
+    consumers: (net.Socket | undefined)[],
+    data: Buffer
+  ): Promise<void> {
+    const backedUp: net.Socket[] = [];
+    for (const consumer of consumers) {
+      if (!consumer || consumer.destroyed || consumer.writableEnded) {
+        continue;
+      }
+      consumer.write(data);
+      const queued = consumer.writableLength;
+      this._stats.peakQueuedBytes = Math.max(this._stats.peakQueuedBytes, queued);
+      if (queued > this.highWaterMark) {
+        backedUp.push(consumer);
+      }
+    }
+
+    if (backedUp.length === 0 || this._waiting) {
+      return this._waiting ?? Promise.resolve();
+    }
+
+    this._stats.pauses++;
+    source?.pause();
+    this._waiting = Promise.all(backedUp.map(waitForDrain)).then(() => {
+      this._waiting = null;
+      source?.resume();
+    });
+    return this._waiting;
+  }
+}
+
+function waitForDrain(socket: net.Socket): Promise<void> {
+  return new Promise((resolve) => {
+    const done = () => {
+      socket.off("drain", done);
+      socket.off("close", done);
+      resolve();
+    };
+    socket.on("drain", done);
+    socket.on("close", done);
+  });
+}
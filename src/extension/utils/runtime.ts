@@ -4,12 +4,14 @@ import { createRequire } from "node:module";
 import * as net from "node:net";
 import os from "node:os";
 import * as path from "node:path";
+import { StringDecoder } from "node:string_decoder";
 import * as vscode from "vscode";
 
 import { getFileRunSettings } from "./vscode";
 import { getLogger } from "./logging";
+import { hashFile } from "./hash";
 import type { Status } from "../../shared/enums";
-import type { LanguageSettings } from "../../shared/schemas";
+import type { LanguageSettings, RuntimeProfile } from "../../shared/schemas";
 
 function arrayEquals<T>(a: T[], b: T[]): boolean {
   if (a.length !== b.length) {
@@ -20,14 +22,137 @@ function arrayEquals<T>(a: T[], b: T[]): boolean {
 }
 
 type AddonResult = {
-  elapsedMs: number;
+  elapsedMs: number; // time charged against the limit, CPU or wall per timeLimitMode
+  cpuMs: number;
+  wallMs: number;
+  threadCount: number; // peak number of threads seen while sampling
+  threadCpuMs: number[]; // CPU time of each sampled thread, busiest first
   peakMemoryBytes: number;
+  hugePageBytes?: number; // peak anonymous memory in transparent huge pages, Linux only
   exitCode: number | null;
   timedOut: boolean;
   memoryLimitExceeded: boolean;
   stopped: boolean;
 };
 
+export type TimeLimitMode = "cpu" | "wall";
+
+export type HugePagesPolicy = "system" | "never" | "always";
+
+export type MemoryPolicy = {
+  transparentHugePages: HugePagesPolicy;
+  prefault: boolean; // fault in static arrays before main, charging them in full
+};
+
+export type SpawnOptions = {
+  cpuAffinity?: number; // pin the process to this CPU index (ignored on macOS)
+  timeLimitMode?: TimeLimitMode; // which time the time limit applies to, CPU by default
+  env?: Record<string, string>; // added to the extension's own environment
+  runtimeProfile?: RuntimeProfile; // sizes a managed runtime to the memory limit
+  forkServer?: ForkServer; // fork the process from here instead, command and env are ignored
+  memoryPolicy?: MemoryPolicy; // Linux only, and not applied to fork server children
+  cancelGroup?: CancelGroup; // stopped along with the rest of the group
+};
+
+// The addon takes the child's whole environment as "KEY=VALUE" strings
+type NativeSpawnOptions = Omit<
+  SpawnOptions,
+  "env" | "runtimeProfile" | "forkServer" | "memoryPolicy" | "cancelGroup"
+> & {
+  env?: string[];
+  transparentHugePages?: HugePagesPolicy; // only "never" is handled natively
+  cancelGroup?: NativeCancelGroup;
+};
+
+// Memory policy for solution runs, so judge memory behavior can be reproduced
+export function getMemoryPolicy(): MemoryPolicy {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return {
+    transparentHugePages: config.get<HugePagesPolicy>("transparentHugePages", "system"),
+    prefault: config.get<boolean>("prefaultMemory", false),
+  };
+}
+
+// Whether the time limit is charged against CPU time or wall time
+export function getTimeLimitMode(): TimeLimitMode {
+  const config = vscode.workspace.getConfiguration("fastolympiccoding");
+  return config.get<TimeLimitMode>("timeLimitMode", "cpu");
+}
+
+let memoryShimPath: string | null | undefined;
+
+/**
+ * Environment that preloads the memory shim for the parts of the policy that have to be
+ * applied from inside the process. Huge pages also get the glibc 2.35+ malloc tunable, which
+ * advises them on the memory malloc maps later. Empty when nothing needs the shim.
+ */
+function getMemoryPolicyEnv(policy: MemoryPolicy | undefined): Record<string, string> {
+  const hugePages = policy?.transparentHugePages === "always";
+  if (process.platform !== "linux" || (!hugePages && !policy?.prefault)) {
+    return {};
+  }
+
+  if (memoryShimPath === undefined) {
+    const shimPath = path.join(__dirname, "linux-memory-shim.so");
+    memoryShimPath = fs.existsSync(shimPath) ? shimPath : null;
+    if (!memoryShimPath) {
+      getLogger("runtime").warn(`Memory shim not found at ${shimPath}`);
+    }
+  }
+  if (!memoryShimPath) {
+    return {};
+  }
+
+  // Keep any preloads the user already has after the shim, like the fork server does
+  const preload = process.env.LD_PRELOAD;
+  const env: Record<string, string> = {
+    LD_PRELOAD: preload ? `${memoryShimPath}:${preload}` : memoryShimPath,
+  };
+  if (hugePages) {
+    const tunables = process.env.GLIBC_TUNABLES;
+    env.FOC_HUGE_PAGES = "always";
+    env.GLIBC_TUNABLES = tunables ? `${tunables}:glibc.malloc.hugetlb=1` : "glibc.malloc.hugetlb=1";
+  }
+  if (policy?.prefault) {
+    env.FOC_PREFAULT = "1";
+  }
+  return env;
+}
+
+// Share of the memory limit given to the managed heap. The rest covers the runtime itself,
+// JIT code, and thread stacks, which the process monitor counts too.
+const MANAGED_HEAP_SHARE = 0.75;
+
+/**
+ * Derives runtime flags and environment from the memory limit, so the JVM, PyPy, and Node
+ * size their heaps like they would on a judge instead of from host RAM. Flags go right
+ * after the executable. Returns the command unchanged without a memory limit.
+ */
+export function applyRuntimeProfile(
+  command: string[],
+  memoryLimit: number,
+  profile: RuntimeProfile | undefined
+): { command: string[]; env?: Record<string, string> } {
+  if (!profile || memoryLimit <= 0) {
+    return { command };
+  }
+
+  const heap = Math.max(Math.floor(memoryLimit * MANAGED_HEAP_SHARE), 16);
+  const [executable, ...args] = command;
+  switch (profile) {
+    case "jvm": {
+      // Serial GC is what judges run single-core solutions with, and has the smallest footprint
+      const stack = Math.min(64, Math.max(Math.floor(memoryLimit / 8), 1));
+      const flags = [`-Xmx${heap}m`, `-Xss${stack}m`, "-XX:+UseSerialGC"];
+      return { command: [executable, ...flags, ...args] };
+    }
+    case "pypy":
+      return { command, env: { PYPY_GC_MAX: `${heap}MB` } };
+    case "node":
+      return { command: [executable, `--max-old-space-size=${heap}`, ...args] };
+  }
+}
+
 type NativeSpawnResult = {
   pid: number;
   stdio: [number, number, number]; // stdin, stdout, stderr FDs
@@ -35,6 +160,11 @@ type NativeSpawnResult = {
   cancel: () => void;
 };
 
+type NativeCancelGroup = {
+  cancel: () => number; // how many members were still running
+  handle: unknown;
+};
+
 type ProcessMonitorAddon = {
   spawn: (
     command: string,
@@ -45,8 +175,38 @@ type ProcessMonitorAddon = {
     pipeIn: string,
     pipeOut: string,
     pipeErr: string,
-    onSpawn: () => void
+    onSpawn: () => void,
+    options?: NativeSpawnOptions
   ) => NativeSpawnResult;
+  // Linux only
+  startForkServer?: (
+    command: string,
+    args: string[],
+    cwd: string,
+    shimPath: string,
+    options?: Pick<NativeSpawnOptions, "env">
+  ) => Promise<ForkServer>;
+  // Linux only
+  createCancelGroup?: () => NativeCancelGroup;
+};
+
+/**
+ * A compiled program stopped right before `main` by the fork server shim. Every spawn forks
+ * a fresh child from there, skipping exec, dynamic linking, and static initialization.
+ * Runs one child at a time, and must be closed when done.
+ */
+export type ForkServer = {
+  pid: number;
+  spawn: (
+    timeoutMs: number,
+    memoryLimitMB: number,
+    pipeIn: string,
+    pipeOut: string,
+    pipeErr: string,
+    onSpawn: () => void,
+    options?: NativeSpawnOptions
+  ) => NativeSpawnResult;
+  close: () => void;
 };
 
 let processMonitor: ProcessMonitorAddon | null = null;
@@ -95,6 +255,146 @@ function getNativeProcessMonitor(): ProcessMonitorAddon | null {
   }
 }
 
+/**
+ * Starts a fork server for a dynamically linked program. Returns null where fork servers
+ * aren't supported or the program can't run under one, so callers can spawn normally.
+ */
+export async function startForkServer(
+  command: string[],
+  cwd?: string
+): Promise<ForkServer | null> {
+  const logger = getLogger("runtime");
+  const monitor = getNativeProcessMonitor();
+  if (!monitor?.startForkServer) {
+    return null;
+  }
+
+  const shimPath = path.join(__dirname, "linux-forkserver-shim.so");
+  if (!fs.existsSync(shimPath)) {
+    logger.warn(`Fork server shim not found at ${shimPath}`);
+    return null;
+  }
+
+  const [commandName, ...commandArgs] = command;
+  try {
+    const server = await monitor.startForkServer(commandName, commandArgs, cwd || "", shimPath);
+    logger.info(`Started fork server for ${commandName} (pid=${server.pid})`);
+    return server;
+  } catch (err) {
+    logger.warn(
+      `Fork server unavailable for ${commandName}, spawning normally: ${err instanceof Error ? err.message : String(err)}`
+    );
+    return null;
+  }
+}
+
+/**
+ * Runs that are stopped together, like a file's testcases or a stress session. Where the
+ * addon supports it, `cancel` kills every member in one native call, including runs whose
+ * stdio is still connecting, without waiting for each run's monitor thread to wake up.
+ * Elsewhere it stops the members one by one. A group can be reused after `cancel`.
+ */
+export class CancelGroup {
+  readonly native = getNativeProcessMonitor()?.createCancelGroup?.();
+  private _runs = new Set<Runnable>();
+  private _generation = 0;
+
+  // Bumped by every cancel, so work queued before one can tell it shouldn't start
+  get generation(): number {
+    return this._generation;
+  }
+
+  add(run: Runnable) {
+    this._runs.add(run);
+  }
+
+  delete(run: Runnable) {
+    this._runs.delete(run);
+  }
+
+  // Returns how many runs were stopped
+  cancel(): number {
+    this._generation++;
+    this.native?.cancel();
+    // Also covers runs that haven't reached the addon yet
+    for (const run of this._runs) {
+      run.stop();
+    }
+    return this._runs.size;
+  }
+}
+
+type PipeSet = {
+  servers: [net.Server, net.Server, net.Server];
+  paths: [string, string, string];
+};
+
+// Opens the stdin/stdout/stderr pipe servers the native monitor connects a process to
+async function createPipeSet(): Promise<PipeSet> {
+  const createPipeServer = (name: string): Promise<net.Server> => {
+    return new Promise((resolve, reject) => {
+      const server = net.createServer();
+      server.listen(name, () => resolve(server));
+      server.on("error", reject);
+    });
+  };
+
+  const id = crypto.randomBytes(8).toString("hex");
+  let paths: [string, string, string];
+  if (process.platform === "win32") {
+    paths = [
+      `\\\\.\\pipe\\foc-${id}-in`,
+      `\\\\.\\pipe\\foc-${id}-out`,
+      `\\\\.\\pipe\\foc-${id}-err`,
+    ];
+  } else {
+    const tmpDir = os.tmpdir();
+    paths = [
+      path.join(tmpDir, `foc-${id}-in.sock`),
+      path.join(tmpDir, `foc-${id}-out.sock`),
+      path.join(tmpDir, `foc-${id}-err.sock`),
+    ];
+  }
+
+  const servers = await Promise.all(paths.map(createPipeServer));
+  return { servers: servers as PipeSet["servers"], paths };
+}
+
+// Pipe set opened ahead of time by preloadProcessMonitor, handed to the first native run
+let warmPipeSet: Promise<PipeSet> | null = null;
+
+function takePipeSet(): Promise<PipeSet> {
+  const warm = warmPipeSet;
+  warmPipeSet = null;
+  return warm ? warm.catch(() => createPipeSet()) : createPipeSet();
+}
+
+/**
+ * Loads and validates the native process monitor and opens one pipe set for the first run,
+ * so neither cost lands on the first click. Meant to run once activation is done; the
+ * returned disposable closes the pipes if no run took them.
+ */
+export function preloadProcessMonitor(): vscode.Disposable {
+  const monitor = getNativeProcessMonitor();
+  if (monitor && !warmPipeSet) {
+    warmPipeSet = createPipeSet();
+    warmPipeSet.catch((err: unknown) => {
+      getLogger("runtime").debug(
+        `Pipe warm-up failed, runs open their own: ${err instanceof Error ? err.message : String(err)}`
+      );
+    });
+  }
+
+  return new vscode.Disposable(() => {
+    const warm = warmPipeSet;
+    warmPipeSet = null;
+    void warm?.then(
+      (pipes) => pipes.servers.forEach((server) => server.close()),
+      () => {}
+    );
+  });
+}
+
 // ============================================================================
 // RunSession API Types
 // ============================================================================
@@ -194,9 +494,14 @@ export class Runnable extends EventEmitter {
   private _promise: Promise<void> | undefined = undefined;
   private _spawnPromise: Promise<boolean> | undefined = undefined;
   private _elapsed = 0;
+  private _cpuTime = 0;
+  private _wallTime = 0;
+  private _threadCount = 0;
+  private _threadCpuTimes: number[] = [];
   private _timedOut = false;
   private _exitCode: number | null = null;
   private _maxMemoryBytes = 0;
+  private _hugePageBytes = 0;
   private _memoryLimitExceeded = false;
   private _stopped = false;
   private _termination: RunTermination = "exit";
@@ -239,7 +544,12 @@ export class Runnable extends EventEmitter {
 
   handleAddonResult(result: AddonResult): void {
     this._elapsed = result.elapsedMs;
+    this._cpuTime = result.cpuMs;
+    this._wallTime = result.wallMs;
+    this._threadCount = result.threadCount;
+    this._threadCpuTimes = result.threadCpuMs;
     this._maxMemoryBytes = result.peakMemoryBytes;
+    this._hugePageBytes = result.hugePageBytes ?? 0;
     this._timedOut = result.timedOut;
     this._memoryLimitExceeded = result.memoryLimitExceeded;
     this._stopped = result.stopped;
@@ -247,17 +557,46 @@ export class Runnable extends EventEmitter {
     this._termination = this._computeTermination();
   }
 
-  run(command: string[], timeout: number, memoryLimit: number, cwd?: string) {
+  run(
+    command: string[],
+    timeout: number,
+    memoryLimit: number,
+    cwd?: string,
+    options?: SpawnOptions
+  ) {
     if (command.length === 0) {
       throw new Error("Runnable.run requires at least one command element");
     }
 
-    const [commandName, ...commandArgs] = command;
+    const profiled = applyRuntimeProfile(command, memoryLimit, options?.runtimeProfile);
+    const [commandName, ...commandArgs] = profiled.command;
+    const extraEnv = {
+      ...profiled.env,
+      ...getMemoryPolicyEnv(options?.memoryPolicy),
+      ...options?.env,
+    };
+    const nativeOptions: NativeSpawnOptions = {
+      cpuAffinity: options?.cpuAffinity,
+      timeLimitMode: options?.timeLimitMode,
+      transparentHugePages: options?.memoryPolicy?.transparentHugePages,
+      env:
+        Object.keys(extraEnv).length > 0
+          ? Object.entries({ ...process.env, ...extraEnv })
+              .filter(([, value]) => value !== undefined)
+              .map(([key, value]) => `${key}=${value}`)
+          : undefined,
+      cancelGroup: options?.cancelGroup?.native,
+    };
 
     this._elapsed = 0;
+    this._cpuTime = 0;
+    this._wallTime = 0;
+    this._threadCount = 0;
+    this._threadCpuTimes = [];
     this._exitCode = null;
     this._timedOut = false;
     this._maxMemoryBytes = 0;
+    this._hugePageBytes = 0;
     this._memoryLimitExceeded = false;
     this._stopped = false;
     this._termination = "exit";
@@ -280,35 +619,9 @@ export class Runnable extends EventEmitter {
           try {
             // Initialize pipes if needed
             if (!this._pipeServers) {
-              const createPipeServer = (name: string): Promise<net.Server> => {
-                return new Promise((resolve, reject) => {
-                  const server = net.createServer();
-                  server.listen(name, () => resolve(server));
-                  server.on("error", reject);
-                });
-              };
-
-              const id = crypto.randomBytes(8).toString("hex");
-              let pipeNameIn: string, pipeNameOut: string, pipeNameErr: string;
-
-              if (process.platform === "win32") {
-                pipeNameIn = `\\\\.\\pipe\\foc-${id}-in`;
-                pipeNameOut = `\\\\.\\pipe\\foc-${id}-out`;
-                pipeNameErr = `\\\\.\\pipe\\foc-${id}-err`;
-              } else {
-                const tmpDir = os.tmpdir();
-                pipeNameIn = path.join(tmpDir, `foc-${id}-in.sock`);
-                pipeNameOut = path.join(tmpDir, `foc-${id}-out.sock`);
-                pipeNameErr = path.join(tmpDir, `foc-${id}-err.sock`);
-              }
-
-              const servers = await Promise.all([
-                createPipeServer(pipeNameIn),
-                createPipeServer(pipeNameOut),
-                createPipeServer(pipeNameErr),
-              ]);
-              this._pipeServers = servers as [net.Server, net.Server, net.Server];
-              this._pipePaths = [pipeNameIn, pipeNameOut, pipeNameErr];
+              const pipes = await takePipeSet();
+              this._pipeServers = pipes.servers;
+              this._pipePaths = pipes.paths;
             }
 
             const [serverIn, serverOut, serverErr] = this._pipeServers!;
@@ -339,17 +652,28 @@ export class Runnable extends EventEmitter {
             const pErr = waitForConnection(serverErr);
 
             // Call native spawn now that listeners are setup
-            const spawnResult = monitor.spawn(
-              commandName,
-              commandArgs,
-              cwd || "",
-              timeout,
-              memoryLimit,
-              pipeNameIn,
-              pipeNameOut,
-              pipeNameErr,
-              () => {} // Callback unused in this flow setup
-            );
+            const spawnResult = options?.forkServer
+              ? options.forkServer.spawn(
+                  timeout,
+                  memoryLimit,
+                  pipeNameIn,
+                  pipeNameOut,
+                  pipeNameErr,
+                  () => {},
+                  nativeOptions
+                )
+              : monitor.spawn(
+                  commandName,
+                  commandArgs,
+                  cwd || "",
+                  timeout,
+                  memoryLimit,
+                  pipeNameIn,
+                  pipeNameOut,
+                  pipeNameErr,
+                  () => {}, // Callback unused in this flow setup
+                  nativeOptions
+                );
 
             const [socketIn, socketOut, socketErr] = await Promise.all([pIn, pOut, pErr]);
 
@@ -358,15 +682,14 @@ export class Runnable extends EventEmitter {
             this.stdout = socketOut;
             this.stderr = socketErr;
             this._cancel = spawnResult.cancel;
-
-            this.stdout.setEncoding("utf-8");
-            this.stderr.setEncoding("utf-8");
+            if (this._stopped) {
+              // Stopped while its stdio connected
+              this._cancel();
+            }
 
             // Proxy events
-            this.stdout.on("data", (data) => this.emit("stdout:data", data));
-            this.stderr.on("data", (data) => this.emit("stderr:data", data));
-            this.stdout.once("end", () => this.emit("stdout:end"));
-            this.stderr.once("end", () => this.emit("stderr:end"));
+            this._proxyOutput(this.stdout, "stdout");
+            this._proxyOutput(this.stderr, "stderr");
 
             resolveSpawn(true);
             this.emit("spawn");
@@ -422,11 +745,53 @@ export class Runnable extends EventEmitter {
         }
       })();
     });
+
+    const cancelGroup = options?.cancelGroup;
+    if (cancelGroup) {
+      cancelGroup.add(this);
+      void this._promise.then(() => cancelGroup.delete(this));
+    }
+  }
+
+  // Streams stay binary. ":bytes" listeners get the chunks as they arrive, so relays and
+  // output capture never decode them; ":data" listeners get UTF-8 text, decoded only if any
+  // are attached.
+  private _proxyOutput(stream: net.Socket, name: "stdout" | "stderr") {
+    const decoder = new StringDecoder("utf-8");
+    stream.on("data", (chunk: Buffer) => {
+      this.emit(`${name}:bytes`, chunk);
+      if (this.listenerCount(`${name}:data`) > 0) {
+        this.emit(`${name}:data`, decoder.write(chunk));
+      }
+    });
+    stream.once("end", () => {
+      const rest = decoder.end();
+      if (rest && this.listenerCount(`${name}:data`) > 0) {
+        this.emit(`${name}:data`, rest);
+      }
+      this.emit(`${name}:end`);
+    });
   }
 
   get elapsed(): number {
     return this._elapsed;
   }
+  get cpuTime(): number {
+    return this._cpuTime;
+  }
+  get wallTime(): number {
+    return this._wallTime;
+  }
+  get threadCount(): number {
+    return this._threadCount;
+  }
+  get threadCpuTimes(): number[] {
+    return this._threadCpuTimes;
+  }
+  // CPU time over wall time, above 1 when several threads ran at once
+  get parallelism(): number {
+    return this._wallTime > 0 ? this._cpuTime / this._wallTime : 0;
+  }
   get timedOut(): boolean {
     return this._timedOut;
   }
@@ -436,6 +801,9 @@ export class Runnable extends EventEmitter {
   get maxMemoryBytes(): number {
     return this._maxMemoryBytes;
   }
+  get hugePageBytes(): number {
+    return this._hugePageBytes;
+  }
   get memoryLimitExceeded(): boolean {
     return this._memoryLimitExceeded;
   }
@@ -472,6 +840,7 @@ export class Runnable extends EventEmitter {
   on(event: "spawn", listener: () => void): this;
   on(event: "error", listener: (err: Error) => void): this;
   on(event: "stderr:data" | "stdout:data", listener: (data: string) => void): this;
+  on(event: "stderr:bytes" | "stdout:bytes", listener: (data: Buffer) => void): this;
   on(event: "stderr:end" | "stdout:end", listener: () => void): this;
   on(event: "close", listener: (code: number | null, signal: NodeJS.Signals | null) => void): this;
   on(event: string, listener: ListenerCallback): this {
@@ -496,9 +865,8 @@ export class Runnable extends EventEmitter {
   }
 }
 
-export async function getFileChecksum(file: string): Promise<string> {
-  const content = await fs.promises.readFile(file);
-  return crypto.createHash("md5").update(content).digest("hex");
+export function getFileChecksum(file: string): Promise<string> {
+  return hashFile(file);
 }
 
 export type CompilationResult = {
@@ -510,15 +878,16 @@ export type CompilationResult = {
 async function doCompile(
   file: string,
   compileCommand: string[],
-  context: vscode.ExtensionContext
+  context: vscode.ExtensionContext,
+  cacheKey = file
 ): Promise<CompilationResult> {
   const currentChecksum = await getFileChecksum(file);
-  const [cachedChecksum, cachedCommand] = lastCompiled.get(file) ?? [-1, []];
+  const [cachedChecksum, cachedCommand] = lastCompiled.get(cacheKey) ?? [-1, []];
   if (currentChecksum === cachedChecksum && arrayEquals(compileCommand, cachedCommand)) {
     return { code: 0, stdout: "", stderr: "" }; // avoid unnecessary recompilation
   }
 
-  let promise = compilePromise.get(file);
+  let promise = compilePromise.get(cacheKey);
   if (!promise) {
     promise = (async () => {
       const logger = getLogger("compilation");
@@ -561,7 +930,7 @@ async function doCompile(
           `Compilation failed (file=${file}, command=${compileCommand}, exitCode=${runnable.exitCode}, termination=${runnable.termination})`
         );
       } else {
-        lastCompiled.set(file, [currentChecksum, compileCommand]);
+        lastCompiled.set(cacheKey, [currentChecksum, compileCommand]);
       }
 
       return {
@@ -570,14 +939,15 @@ async function doCompile(
         stderr: err,
       };
     })();
-    compilePromise.set(file, promise);
+    compilePromise.set(cacheKey, promise);
   }
 
   const result = await promise;
-  compilePromise.delete(file);
+  compilePromise.delete(cacheKey);
   return result;
 }
 
+// Keyed by file, or by file and flag set tag for variant builds
 const lastCompiled: Map<string, [string, string[]]> = new Map(); // [file checksum, compile command]
 const compilePromise: Map<string, Promise<CompilationResult>> = new Map();
 
@@ -598,6 +968,58 @@ export function compile(
   return doCompile(file, languageSettings.compileCommand, context);
 }
 
+/**
+ * Compiles a file with an explicit command instead of its run settings. Used for sources
+ * bundled with the extension, which live outside of any workspace.
+ */
+export function compileWithCommand(
+  file: string,
+  compileCommand: string[],
+  context: vscode.ExtensionContext
+): Promise<CompilationResult> {
+  return doCompile(file, compileCommand, context);
+}
+
+export type VariantBuild = {
+  result: Promise<CompilationResult>;
+  languageSettings: LanguageSettings;
+};
+
+/**
+ * Compiles the file with extra flags appended to its compile command. The output is
+ * redirected by overriding `${fileBasenameNoExtension}`, so every flag set gets its own
+ * binary and compile cache entry. Returns null if the run settings are invalid or the
+ * compile command doesn't name its output after the file.
+ */
+export function compileVariant(
+  file: string,
+  flags: string[],
+  context: vscode.ExtensionContext
+): VariantBuild | null {
+  const tag = crypto.createHash("md5").update(flags.join("\0")).digest("hex").slice(0, 8);
+  const baseSettings = getFileRunSettings(file);
+  const settings = getFileRunSettings(file, {
+    fileBasenameNoExtension: `${path.parse(file).name}.${tag}`,
+  });
+  if (!baseSettings || !settings) {
+    return null;
+  }
+
+  const { compileCommand, runCommand } = settings.languageSettings;
+  const baseCompileCommand = baseSettings.languageSettings.compileCommand;
+  if (!compileCommand || !runCommand || arrayEquals(compileCommand, baseCompileCommand ?? [])) {
+    getLogger("compilation").error(
+      `Cannot build flag variants of ${file}: compileCommand must write its output to \${fileBasenameNoExtension}`
+    );
+    return null;
+  }
+
+  return {
+    result: doCompile(file, [...compileCommand, ...flags], context, `${file}:${tag}`),
+    languageSettings: settings.languageSettings,
+  };
+}
+
 export function clearCompileCache(): void {
   lastCompiled.clear();
 }
@@ -621,3 +1043,73 @@ export async function findAvailablePort(): Promise<number> {
     server.on("error", reject);
   });
 }
+
+// ============================================================================
+// Scratch directories - Isolated working directories for file I/O problems
+// ============================================================================
+
+// Prefer RAM-backed tmpfs so file I/O problems don't hit the disk on every run
+function getScratchRoot(): string {
+  if (process.platform === "linux") {
+    try {
+      fs.accessSync("/dev/shm", fs.constants.W_OK);
+      return "/dev/shm";
+    } catch {
+      // fall back to the regular temporary directory
+    }
+  }
+  return os.tmpdir();
+}
+
+// Resolves a declared file inside the scratch directory, rejecting names that escape it
+function resolveScratchFile(directory: string, name: string): string | null {
+  const file = path.resolve(directory, name);
+  const relative = path.relative(directory, file);
+  return relative && !relative.startsWith("..") && !path.isAbsolute(relative) ? file : null;
+}
+
+/**
+ * Creates a private working directory for a single run and writes the input file into it,
+ * so concurrent runs of a file I/O problem can't clobber each other's files.
+ */
+export async function createScratchDirectory(
+  inputFile: string | undefined,
+  input: string
+): Promise<string> {
+  const directory = await fs.promises.mkdtemp(path.join(getScratchRoot(), "foc-run-"));
+  if (inputFile) {
+    const file = resolveScratchFile(directory, inputFile);
+    if (!file) {
+      await removeScratchDirectory(directory);
+      throw new Error(`Input file ${inputFile} must be inside the working directory`);
+    }
+    await fs.promises.mkdir(path.dirname(file), { recursive: true });
+    await fs.promises.writeFile(file, input);
+  }
+  return directory;
+}
+
+/**
+ * Reads the declared output file of a finished run. A missing file is treated as empty
+ * output, the same as a solution that printed nothing.
+ */
+export async function readScratchOutput(directory: string, outputFile: string): Promise<Buffer> {
+  const file = resolveScratchFile(directory, outputFile);
+  if (!file) {
+    return Buffer.alloc(0);
+  }
+  try {
+    return await fs.promises.readFile(file);
+  } catch {
+    return Buffer.alloc(0);
+  }
+}
+
+export async function removeScratchDirectory(directory: string): Promise<void> {
+  try {
+    await fs.promises.rm(directory, { recursive: true, force: true });
+  } catch (error) {
+    const errorMessage = error instanceof Error ? error.message : String(error);
+    getLogger("runtime").warn(`Failed to remove scratch directory ${directory}: ${errorMessage}`);
+  }
+}
@@ -0,0 +1,144 @@
+// Cap on remembered hashes per band, after which the band starts over from empty sets
+const MAX_REMEMBERED_HASHES = 50_000;
+
+type Band = {
+  min: number;
+  max: number;
+  iterations: number;
+  elapsed: number; // ms spent on iterations of this band
+  novel: number; // iterations that produced an unseen input or outcome
+  inputs: Set<string>;
+  outcomes: Set<string>;
+  distinctInputs: number;
+  distinctOutcomes: number;
+  failureSizes: number[];
+};
+
+// Size ranges growing by a factor of 4 up to the maximum
+function getBandRanges(maxSize: number): { min: number; max: number }[] {
+  const ranges: { min: number; max: number }[] = [];
+  for (let min = 1; min <= maxSize; min *= 4) {
+    ranges.push({ min, max: Math.min(min * 4 - 1, maxSize) });
+  }
+  return ranges;
+}
+
+function randomSize({ min, max }: { min: number; max: number }): number {
+  return min + Math.floor(Math.random() * (max - min + 1));
+}
+
+/**
+ * Picks a size hint without any feedback, for generator runs outside a stress session. The
+ * band is uniform, so small and large inputs are about equally common.
+ */
+export function sampleSize(maxSize: number): number {
+  const ranges = getBandRanges(maxSize);
+  return randomSize(ranges[Math.floor(Math.random() * ranges.length)]);
+}
+
+/**
+ * Picks the size hint for each stress iteration. Sizes are split into bands growing by
+ * a factor of 4 up to the configured maximum. Every iteration alternates between the
+ * smaller and larger half of the bands, and within a half picks the band with the best
+ * upper confidence bound on novel inputs or outcomes per second. Sizes that produce
+ * nothing new, or produce it slowly, get fewer iterations.
+ */
+export class SizeTuner {
+  private _bands: Band[] = [];
+  private _current = 0;
+  private _iterations = 0;
+  private _large = false;
+
+  constructor(maxSize: number) {
+    for (const { min, max } of getBandRanges(maxSize)) {
+      this._bands.push({
+        min,
+        max,
+        iterations: 0,
+        elapsed: 0,
+        novel: 0,
+        inputs: new Set(),
+        outcomes: new Set(),
+        distinctInputs: 0,
+        distinctOutcomes: 0,
+        failureSizes: [],
+      });
+    }
+  }
+
+  next(): number {
+    const half = Math.ceil(this._bands.length / 2);
+    const candidates = this._large
+      ? this._bands.slice(this._bands.length - half)
+      : this._bands.slice(0, half);
+    this._large = !this._large;
+
+    const rates = this._bands.map((band) =>
+      band.iterations === 0 ? 0 : band.novel / Math.max(band.elapsed, 1)
+    );
+    const bestRate = Math.max(...rates, Number.MIN_VALUE);
+
+    let best = candidates[0];
+    let bestScore = -Infinity;
+    for (const band of candidates) {
+      if (band.iterations === 0) {
+        best = band;
+        break;
+      }
+      const rate = band.novel / Math.max(band.elapsed, 1);
+      const score =
+        rate / bestRate + Math.sqrt((2 * Math.log(this._iterations + 1)) / band.iterations);
+      if (score > bestScore) {
+        bestScore = score;
+        best = band;
+      }
+    }
+
+    this._current = this._bands.indexOf(best);
+    return randomSize(best);
+  }
+
+  // Takes digests of the input and outcome, hashed while they streamed
+  record(size: number, elapsed: number, inputHash: string, outcomeHash: string, failed: boolean) {
+    const band = this._bands[this._current];
+    if (band.inputs.size >= MAX_REMEMBERED_HASHES) {
+      band.inputs.clear();
+      band.outcomes.clear();
+    }
+
+    const newInput = !band.inputs.has(inputHash);
+    const newOutcome = !band.outcomes.has(outcomeHash);
+    band.inputs.add(inputHash);
+    band.outcomes.add(outcomeHash);
+
+    band.iterations++;
+    band.elapsed += elapsed;
+    band.novel += newInput || newOutcome ? 1 : 0;
+    band.distinctInputs += newInput ? 1 : 0;
+    band.distinctOutcomes += newOutcome ? 1 : 0;
+    if (failed) {
+      band.failureSizes.push(size);
+    }
+    this._iterations++;
+  }
+
+  formatReport(file: string): string {
+    const lines = [
+      "# Stress Test Sizes",
+      "",
+      `${file}, ${this._iterations} iterations`,
+      "",
+      "| Sizes | Iterations | Iterations/s | Distinct inputs | Distinct outcomes | Failures at size |",
+      "|---|---:|---:|---:|---:|---|",
+    ];
+    for (const band of this._bands) {
+      const perSecond =
+        band.elapsed > 0 ? ((band.iterations * 1000) / band.elapsed).toFixed(1) : "—";
+      const failures = band.failureSizes.length > 0 ? band.failureSizes.join(", ") : "—";
+      lines.push(
+        `| ${band.min}–${band.max} | ${band.iterations} | ${perSecond} | ${band.distinctInputs} | ${band.distinctOutcomes} | ${failures} |`
+      );
+    }
+    return lines.join("\n");
+  }
+}
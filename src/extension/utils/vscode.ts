@@ -1,11 +1,13 @@
 import * as fs from "node:fs";
 import * as os from "node:os";
 import * as path from "node:path";
+import { StringDecoder } from "node:string_decoder";
 import * as vscode from "vscode";
 import * as v from "valibot";
 
 import { RunSettingsSchema, type LanguageSettings, type RunSettings } from "../../shared/schemas";
 import { type ILogger, getLogger } from "./logging";
+import { isLagThrottled } from "./lagMonitor";
 
 let logger: ILogger;
 
@@ -21,6 +23,8 @@ const STRING_PATH_PROPERTIES = new Set([
   "interactorFile",
   "goodSolutionFile",
   "generatorFile",
+  "inputFile",
+  "outputFile",
   "currentWorkingDirectory",
 ]);
 
@@ -51,6 +55,36 @@ class ReadonlyTerminal implements vscode.Pseudoterminal {
   }
 }
 
+// Byte version of TextHandler's normalization: CRLF becomes LF, spaces before a newline or
+// at the very end are dropped, and a final write ends with a newline. One pass, one copy.
+function normalizeOutput(raw: Buffer, final: boolean): Buffer {
+  const out = Buffer.allocUnsafe(raw.length + 1);
+  let length = 0;
+  let spaces = 0;
+  for (let i = 0; i < raw.length; i++) {
+    const byte = raw[i];
+    if (byte === 0x20) {
+      spaces++;
+    } else if (byte === 0x0d && raw[i + 1] === 0x0a) {
+      continue;
+    } else if (byte === 0x0a) {
+      out[length++] = byte;
+      spaces = 0;
+    } else {
+      if (spaces > 0) {
+        out.fill(0x20, length, length + spaces);
+        length += spaces;
+        spaces = 0;
+      }
+      out[length++] = byte;
+    }
+  }
+  if (final && (length === 0 || out[length - 1] !== 0x0a)) {
+    out[length++] = 0x0a;
+  }
+  return out.subarray(0, length);
+}
+
 /**
  * Handles text data with constraints on maximum display characters and lines.
  *
@@ -59,10 +93,19 @@ class ReadonlyTerminal implements vscode.Pseudoterminal {
  * such as answer checking (e.g., comparison with accepted stdout) or other logic
  * that requires the complete, untruncated output.
  *
+ * While the event loop lags, batch writes are only captured and forced writes are sent
+ * less often, so relaying output doesn't starve the editor. Final writes always flush.
+ *
+ * Process output can be written as Buffers. The chunks are then kept as they are, and only
+ * the display prefix is decoded while it streams. The full text is decoded once, on first
+ * access. Compare `bytes` rather than `data`, so output that isn't valid UTF-8 can't match
+ * through replacement characters.
+ *
  * Competitive Companion states the inputs and outputs must end with a newline!
  */
 export class TextHandler {
   private static readonly INTERVAL: number = 30;
+  private static readonly THROTTLED_INTERVAL: number = 250;
   private static _maxDisplayCharacters: number = vscode.workspace
     .getConfiguration("fastolympiccoding")
     .get("maxDisplayCharacters")!;
@@ -79,6 +122,13 @@ export class TextHandler {
   private _callback: ((data: string) => void) | undefined = undefined;
   private _finalWritten = false;
 
+  // Set once a Buffer is written; _data is unused from then on
+  private _chunks: Buffer[] | undefined = undefined;
+  private _decoder: StringDecoder | undefined = undefined;
+  private _bytes: Buffer | undefined = undefined;
+  private _text: string | undefined = undefined;
+  private _endsWithNewline = false; // of the normalized bytes, so finishing needn't build them
+
   private _appendPendingCharacter(char: string) {
     if (
       this._shortDataLength >= TextHandler._maxDisplayCharacters ||
@@ -91,13 +141,18 @@ export class TextHandler {
     this._newlineCount += char === "\n" ? 1 : 0;
   }
 
-  private _sendPendingIfNeeded(last: boolean) {
+  private _sendPendingIfNeeded(last: boolean, final: boolean) {
     if (this._shortDataLength > TextHandler._maxDisplayCharacters) {
       return;
     }
 
+    const throttled = isLagThrottled() && !final;
+    if (throttled && !last) {
+      return; // capture only
+    }
     const now = Date.now();
-    if (now - this._lastWrite < TextHandler.INTERVAL && !last) {
+    const interval = throttled ? TextHandler.THROTTLED_INTERVAL : TextHandler.INTERVAL;
+    if (now - this._lastWrite < interval && (!last || throttled)) {
       return;
     }
 
@@ -115,28 +170,25 @@ export class TextHandler {
     this._pending = "";
   }
 
-  get data() {
-    return this._data;
-  }
-
-  set callback(callback: (data: string) => void) {
-    this._callback = callback;
+  private _isDisplayFull() {
+    return (
+      this._shortDataLength >= TextHandler._maxDisplayCharacters ||
+      this._newlineCount >= TextHandler._maxDisplayLines
+    );
   }
 
-  write(_data: string, mode: WriteMode) {
-    if (this._finalWritten) {
-      return;
-    }
-
+  // Appends to the display, and to the full version unless the bytes are kept instead
+  private _consume(_data: string, keepData: boolean) {
     const data = _data.replace(/\r\n/g, "\n"); // just avoid \r\n entirely
 
-    // Update the "full" version
     for (let i = 0; i < data.length; i++) {
       if (data[i] === " ") {
         this._spacesCount++;
       } else if (data[i] === "\n") {
         this._appendPendingCharacter("\n");
-        this._data += "\n";
+        if (keepData) {
+          this._data += "\n";
+        }
         this._spacesCount = 0;
       } else {
         for (let j = 0; j < this._spacesCount; j++) {
@@ -144,11 +196,88 @@ export class TextHandler {
         }
         this._appendPendingCharacter(data[i]);
 
-        this._data += " ".repeat(this._spacesCount);
-        this._data += data[i];
+        if (keepData) {
+          this._data += " ".repeat(this._spacesCount);
+          this._data += data[i];
+        }
         this._spacesCount = 0;
       }
     }
+  }
+
+  private _writeBytes(chunk: Buffer, mode: WriteMode) {
+    if (!this._chunks) {
+      // Text written so far is already normalized, so it leads the chunks as is
+      const text = this._data + " ".repeat(this._spacesCount);
+      this._chunks = text.length > 0 ? [Buffer.from(text)] : [];
+      this._endsWithNewline = this._data.at(-1) === "\n";
+      this._data = "";
+      this._decoder = new StringDecoder("utf-8");
+    }
+
+    if (chunk.length > 0) {
+      this._chunks.push(chunk);
+      for (let i = chunk.length - 1; i >= 0; i--) {
+        if (chunk[i] !== 0x20) {
+          this._endsWithNewline = chunk[i] === 0x0a;
+          break;
+        }
+      }
+      this._bytes = undefined;
+      this._text = undefined;
+      // Past the display limit the rest is only kept, never decoded while streaming
+      if (!this._isDisplayFull()) {
+        this._consume(this._decoder!.write(chunk), false);
+      }
+    }
+
+    if (mode === "final") {
+      this._finalWritten = true;
+      this._bytes = undefined;
+      this._text = undefined;
+      if (!this._isDisplayFull()) {
+        this._consume(this._decoder!.end(), false);
+      }
+      if (!this._endsWithNewline) {
+        this._appendPendingCharacter("\n");
+      }
+    }
+    this._sendPendingIfNeeded(mode === "force" || mode === "final", mode === "final");
+  }
+
+  get data() {
+    if (this._chunks) {
+      this._text ??= this.bytes.toString("utf-8");
+      return this._text;
+    }
+    return this._data;
+  }
+
+  // The full output with the same normalization as data, as bytes
+  get bytes(): Buffer {
+    if (!this._chunks) {
+      return Buffer.from(this._data);
+    }
+    this._bytes ??= normalizeOutput(Buffer.concat(this._chunks), this._finalWritten);
+    return this._bytes;
+  }
+
+  set callback(callback: (data: string) => void) {
+    this._callback = callback;
+  }
+
+  write(data: string | Buffer, mode: WriteMode) {
+    if (this._finalWritten) {
+      return;
+    }
+
+    if (typeof data !== "string" || this._chunks) {
+      this._writeBytes(typeof data === "string" ? Buffer.from(data) : data, mode);
+      return;
+    }
+
+    // Update the "full" version
+    this._consume(data, true);
 
     if (mode === "final") {
       this._finalWritten = true;
@@ -157,7 +286,7 @@ export class TextHandler {
         this._data += "\n";
       }
     }
-    this._sendPendingIfNeeded(mode === "force" || mode === "final");
+    this._sendPendingIfNeeded(mode === "force" || mode === "final", mode === "final");
   }
 
   reset() {
@@ -171,10 +300,19 @@ export class TextHandler {
     this._newlineCount = 0;
     this._lastWrite = Number.NEGATIVE_INFINITY;
     this._finalWritten = false;
+    this._chunks = undefined;
+    this._decoder = undefined;
+    this._bytes = undefined;
+    this._text = undefined;
+    this._endsWithNewline = false;
   }
 
   isEmpty() {
     // Consider only newline as empty for Competitive Companion compliance
+    if (this._chunks) {
+      const bytes = this.bytes;
+      return bytes.length === 0 || (bytes.length === 1 && bytes[0] === 0x0a);
+    }
     return this._data.length === 0 || this._data === "\n";
   }
 }
@@ -24,6 +24,7 @@ export const StatusValues = [
   "RUNNING",
   "EDITING",
   "ML",
+  "SB",
 ] as const;
 
 export type Status = (typeof StatusValues)[number];
@@ -14,6 +14,8 @@ export const ActionValues = [
   "DEBUG",
   "REQUEST_DATA",
   "TOGGLE_INTERACTIVE",
+  "SUBTASK",
+  "LINE_COUNTS",
 ] as const;
 
 export type ActionValue = (typeof ActionValues)[number];
@@ -42,6 +44,7 @@ export const ProviderMessageTypeSchema = v.picklist(ProviderMessageTypeValues);
 
 export const LoadedMessageSchema = v.object({
   type: v.literal("LOADED"),
+  startupMs: v.optional(v.number()), // time from navigation to the first render, for the log
 });
 
 export const NextMessageSchema = v.object({
@@ -168,6 +171,11 @@ export const SetMessageSchema = v.object({
     "skipped",
     "mode",
     "interactorSecret",
+    "baselineElapsed",
+    "subtask",
+    "threadCount",
+    "parallelism",
+    "borderlineRuns",
   ]),
   value: v.unknown(),
 });
@@ -193,6 +201,7 @@ export const InitialStateSchema = v.object({
   type: v.literal("INITIAL_STATE"),
   timeLimit: v.number(),
   memoryLimit: v.number(),
+  timeMultiplier: v.number(),
 });
 
 export const SettingsToggleSchema = v.object({
@@ -7,25 +7,113 @@ export type Mode = (typeof MODES)[number];
 export const StateIdValue = ["Generator", "Solution", "Judge"] as const;
 export type StateId = (typeof StateIdValue)[number];
 
+export const RUNTIME_PROFILES = ["jvm", "pypy", "node"] as const;
+export type RuntimeProfile = (typeof RUNTIME_PROFILES)[number];
+
 export const LanguageSettingsSchema = v.object({
   compileCommand: v.optional(v.array(v.string())),
   runCommand: v.optional(v.array(v.string())),
   currentWorkingDirectory: v.optional(v.string()),
   debugCommand: v.optional(v.array(v.string())),
   debugAttachConfig: v.optional(v.string()),
+  runtimeProfile: v.optional(v.picklist(RUNTIME_PROFILES)),
 });
 export type LanguageSettings = v.InferOutput<typeof LanguageSettingsSchema>;
 
+// A literal number or the name of a value bound by an earlier `ints` statement
+const GeneratorValueSchema = v.union([v.number(), v.string()]);
+const GeneratorRangeSchema = v.tuple([GeneratorValueSchema, GeneratorValueSchema]);
+type GeneratorValue = v.InferOutput<typeof GeneratorValueSchema>;
+type GeneratorRange = v.InferOutput<typeof GeneratorRangeSchema>;
+
+export type GeneratorStatement =
+  | { ints: Record<string, GeneratorRange> }
+  | {
+      array: {
+        length: GeneratorValue;
+        range: GeneratorRange;
+        distinct?: boolean;
+        sorted?: boolean;
+      };
+    }
+  | { permutation: GeneratorValue }
+  | { tree: { vertices: GeneratorValue; weights?: GeneratorRange } }
+  | {
+      graph: {
+        vertices: GeneratorValue;
+        edges: GeneratorValue;
+        connected?: boolean;
+        weights?: GeneratorRange;
+      };
+    }
+  | { string: { length: GeneratorValue; alphabet: string } }
+  | { repeat: { count: GeneratorValue; body: GeneratorStatement[] } };
+
+export const GeneratorStatementSchema: v.GenericSchema<GeneratorStatement> = v.lazy(() =>
+  v.union([
+    v.strictObject({ ints: v.record(v.string(), GeneratorRangeSchema) }),
+    v.strictObject({
+      array: v.strictObject({
+        length: GeneratorValueSchema,
+        range: GeneratorRangeSchema,
+        distinct: v.optional(v.boolean()),
+        sorted: v.optional(v.boolean()),
+      }),
+    }),
+    v.strictObject({ permutation: GeneratorValueSchema }),
+    v.strictObject({
+      tree: v.strictObject({
+        vertices: GeneratorValueSchema,
+        weights: v.optional(GeneratorRangeSchema),
+      }),
+    }),
+    v.strictObject({
+      graph: v.strictObject({
+        vertices: GeneratorValueSchema,
+        edges: GeneratorValueSchema,
+        connected: v.optional(v.boolean()),
+        weights: v.optional(GeneratorRangeSchema),
+      }),
+    }),
+    v.strictObject({
+      string: v.strictObject({
+        length: GeneratorValueSchema,
+        alphabet: v.pipe(v.string(), v.minLength(1)),
+      }),
+    }),
+    v.strictObject({
+      repeat: v.strictObject({
+        count: GeneratorValueSchema,
+        body: v.array(GeneratorStatementSchema),
+      }),
+    }),
+  ])
+);
+export const GeneratorSpecSchema = v.array(GeneratorStatementSchema);
+export type GeneratorSpec = v.InferOutput<typeof GeneratorSpecSchema>;
+
+const RUN_SETTINGS_PROPERTIES = [
+  "interactorFile",
+  "goodSolutionFile",
+  "generatorFile",
+  "generatorSpec",
+  "inputFile",
+  "outputFile",
+];
+
 export const RunSettingsSchema = v.pipe(
   v.looseObject({
     interactorFile: v.optional(v.string()),
     goodSolutionFile: v.optional(v.string()),
     generatorFile: v.optional(v.string()),
+    generatorSpec: v.optional(GeneratorSpecSchema),
+    inputFile: v.optional(v.string()),
+    outputFile: v.optional(v.string()),
   }),
   v.check((value) => {
     // Validate that any additional properties have keys starting with '.' (file extension)
     return Object.keys(value).every((key) => {
-      if (key !== "interactorFile" && key !== "goodSolutionFile" && key !== "generatorFile") {
+      if (!RUN_SETTINGS_PROPERTIES.includes(key)) {
         return key.startsWith(".");
       }
       return true; // Skip known properties
@@ -34,7 +122,7 @@ export const RunSettingsSchema = v.pipe(
   v.check((value) => {
     // Validate the values of additional properties match LanguageSettingsSchema
     return Object.entries(value).every(([key, val]) => {
-      if (key !== "interactorFile" && key !== "goodSolutionFile" && key !== "generatorFile") {
+      if (!RUN_SETTINGS_PROPERTIES.includes(key)) {
         return v.safeParse(LanguageSettingsSchema, val).success;
       }
       return true; // Skip known properties
@@ -62,6 +150,11 @@ export const TestcaseSchema = v.object({
   skipped: v.fallback(v.boolean(), false),
   mode: v.fallback(v.picklist(MODES), "standard"),
   interactorSecret: v.fallback(v.string(), ""),
+  baselineElapsed: v.fallback(v.number(), 0),
+  subtask: v.fallback(v.string(), ""),
+  threadCount: v.fallback(v.number(), 0),
+  parallelism: v.fallback(v.number(), 0),
+  borderlineRuns: v.fallback(v.array(v.number()), []),
 });
 
 export const StressDataSchema = v.object({
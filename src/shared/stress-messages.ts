@@ -10,6 +10,7 @@ export const WebviewMessageTypeValues = [
   "SHOW",
   "SET",
   "SETTINGS_TOGGLE",
+  "LAG",
 ] as const;
 
 export type WebviewMessageTypeValue = (typeof WebviewMessageTypeValues)[number];
@@ -61,6 +62,18 @@ export const SetMessageSchema = v.object({
   value: v.unknown(),
 });
 
+// Extension host event loop lag while a session runs, null once it stops
+export const LagMessageSchema = v.object({
+  type: v.literal("LAG"),
+  stats: v.nullable(
+    v.object({
+      p99: v.number(),
+      max: v.number(),
+      throttled: v.boolean(),
+    })
+  ),
+});
+
 export const WebviewMessageSchema = v.union([
   InitMessageSchema,
   StatusMessageSchema,
@@ -69,6 +82,7 @@ export const WebviewMessageSchema = v.union([
   ShowMessageSchema,
   SettingsToggleSchema,
   SetMessageSchema,
+  LagMessageSchema,
 ]);
 
 export type WebviewMessage = v.InferOutput<typeof WebviewMessageSchema>;
@@ -93,6 +107,7 @@ export const ProviderMessageTypeSchema = v.picklist(ProviderMessageTypeValues);
 
 export const LoadedMessageSchema = v.object({
   type: v.literal("LOADED"),
+  startupMs: v.optional(v.number()), // time from navigation to the first render, for the log
 });
 
 export const RunMessageSchema = v.object({
@@ -0,0 +1,16 @@
+// Lazily loaded components are emitted as separate chunks under dist/chunks. The bundler
+// loads them with script and link tags, which need the webview resource URI of dist and the
+// page's script nonce to get past the CSP. The provider puts both on the root element.
+declare let __webpack_public_path__: string;
+declare let __webpack_nonce__: string;
+
+export function configureChunkLoading(root: HTMLElement): void {
+  __webpack_public_path__ = root.dataset.publicPath ?? "";
+  __webpack_nonce__ = root.dataset.nonce ?? "";
+}
+
+// Memoizes a dynamic import so the chunk is requested once and later uses resolve at once
+export function lazy<T>(load: () => Promise<T>): () => Promise<T> {
+  let promise: Promise<T> | undefined;
+  return () => (promise ??= load());
+}
@@ -1,7 +1,9 @@
 import App from "./App.svelte";
 import { mount } from "svelte";
+import { configureChunkLoading } from "../chunks";
 
 const root = document.getElementById("root");
 if (root) {
+  configureChunkLoading(root);
   mount(App, { target: root });
 }
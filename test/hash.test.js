@@ -0,0 +1,102 @@
+const test = require("node:test");
+const assert = require("node:assert");
+const path = require("node:path");
+const fs = require("node:fs");
+const os = require("node:os");
+const crypto = require("node:crypto");
+
+const addonPath = path.join(__dirname, "..", "build", "Release", "hash.node");
+if (!fs.existsSync(addonPath)) {
+  throw new Error(`Addon not found at ${addonPath}. Run 'npm run build:addon' first.`);
+}
+const native = require(addonPath);
+
+// Reference XXH64 digests with seed 0
+const VECTORS = [
+  ["", "ef46db3751d8e999"],
+  ["a", "d24ec4f1a98c6e5b"],
+  ["abc", "44bc2cf5ad770999"],
+  ["Nobody inspects the spammish repetition", "fbcea83c8a378bf1"],
+];
+
+test("Hash: Matches reference digests", () => {
+  for (const [input, digest] of VECTORS) {
+    assert.strictEqual(native.hash(input), digest);
+    assert.strictEqual(native.hash(Buffer.from(input)), digest);
+  }
+});
+
+test("Hash: Rejects other values", () => {
+  assert.throws(() => native.hash(42));
+});
+
+test("Incremental: Any split gives the same digest", () => {
+  const data = crypto.randomBytes(100_003);
+  const expected = native.hash(data);
+  for (const chunkSize of [1, 7, 31, 32, 33, 4096]) {
+    const hasher = native.createHasher();
+    for (let offset = 0; offset < data.length; offset += chunkSize) {
+      hasher.update(data.subarray(offset, offset + chunkSize));
+    }
+    assert.strictEqual(hasher.digest(), expected, `chunk size ${chunkSize}`);
+  }
+});
+
+test("Incremental: Digest doesn't end the hash", () => {
+  const hasher = native.createHasher();
+  hasher.update("abc");
+  assert.strictEqual(hasher.digest(), native.hash("abc"));
+  hasher.update("def");
+  assert.strictEqual(hasher.digest(), native.hash("abcdef"));
+});
+
+test("File: Matches the in-memory digest, by path and by fd", { timeout: 10000 }, async () => {
+  const file = path.join(os.tmpdir(), `foc-hash-${crypto.randomBytes(8).toString("hex")}`);
+  // Larger than one read chunk
+  const data = crypto.randomBytes(3 * 1024 * 1024 + 5);
+  fs.writeFileSync(file, data);
+  try {
+    assert.strictEqual(await native.hashFile(file), native.hash(data));
+    if (process.platform !== "win32") {
+      const fd = fs.openSync(file, "r");
+      try {
+        assert.strictEqual(await native.hashFile(fd), native.hash(data));
+        // Reading from the start leaves the fd usable
+        assert.strictEqual(await native.hashFile(fd), native.hash(data));
+      } finally {
+        fs.closeSync(fd);
+      }
+    }
+  } finally {
+    fs.unlinkSync(file);
+  }
+});
+
+test("File: Missing files reject", async () => {
+  await assert.rejects(native.hashFile(path.join(os.tmpdir(), "foc-hash-missing-123")));
+});
+
+test("Benchmark: XXH64 against MD5", { timeout: 60000 }, (t) => {
+  const sizes = [1024, 64 * 1024, 64 * 1024 * 1024];
+  for (const size of sizes) {
+    const data = crypto.randomBytes(size);
+    const iterations = Math.max(1, Math.floor((256 * 1024 * 1024) / size));
+    const measure = (fn) => {
+      const start = process.hrtime.bigint();
+      for (let i = 0; i < iterations; i++) {
+        fn();
+      }
+      const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+      return (size * iterations) / seconds / 1e9;
+    };
+
+    const xxh = measure(() => native.hash(data));
+    const md5 = measure(() => crypto.createHash("md5").update(data).digest("hex"));
+    t.diagnostic(
+      `${size} bytes: XXH64 ${xxh.toFixed(2)} GB/s, MD5 ${md5.toFixed(2)} GB/s (${(xxh / md5).toFixed(1)}x)`
+    );
+    if (size >= 64 * 1024) {
+      assert.ok(xxh > md5, `XXH64 (${xxh.toFixed(2)} GB/s) should beat MD5 (${md5.toFixed(2)} GB/s)`);
+    }
+  }
+});
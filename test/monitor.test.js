@@ -38,7 +38,14 @@ function createPipeServer(pipeName) {
 }
 
 function spawnPromise(args, options = {}) {
-  const { timeoutMs = 0, memoryLimitMB = 0, input = null, command = process.execPath } = options;
+  const {
+    timeoutMs = 0,
+    memoryLimitMB = 0,
+    input = null,
+    command = process.execPath,
+    spawnOptions = undefined,
+    forkServer = undefined,
+  } = options;
 
   return new Promise((resolve, reject) => {
     (async () => {
@@ -123,17 +130,28 @@ function spawnPromise(args, options = {}) {
           checkConnected();
         });
 
-        const spawnResult = monitor.spawn(
-          command,
-          args,
-          process.cwd(),
-          timeoutMs,
-          memoryLimitMB,
-          pipeNameIn,
-          pipeNameOut,
-          pipeNameErr,
-          () => {} // onSpawn
-        );
+        const spawnResult = forkServer
+          ? forkServer.spawn(
+              timeoutMs,
+              memoryLimitMB,
+              pipeNameIn,
+              pipeNameOut,
+              pipeNameErr,
+              () => {}, // onSpawn
+              spawnOptions
+            )
+          : monitor.spawn(
+              command,
+              args,
+              process.cwd(),
+              timeoutMs,
+              memoryLimitMB,
+              pipeNameIn,
+              pipeNameOut,
+              pipeNameErr,
+              () => {}, // onSpawn
+              spawnOptions
+            );
       } catch (err) {
         if (serverIn) serverIn.close();
         if (serverOut) serverOut.close();
@@ -354,6 +372,28 @@ test("CPU Limit Enforcement: Multi-threaded", { timeout: 20000 }, async () => {
   );
 });
 
+test("Wall Time Limit Mode: Multi-threaded", { timeout: 20000 }, async () => {
+  // In wall mode the same 4-thread burner runs for the full limit instead of a quarter
+  // of it, and its CPU time outgrows its wall time
+  const fixturePath = path.join(__dirname, "fixtures", "cpu_burner.js");
+  if (!fs.existsSync(fixturePath)) {
+    console.warn("Skipping wall time test: fixture not found at " + fixturePath);
+    return;
+  }
+
+  const res = await spawnPromise([fixturePath], {
+    timeoutMs: 1500,
+    spawnOptions: { timeLimitMode: "wall" },
+  });
+
+  assert.strictEqual(res.timedOut, true, "Should have timed out (wall limit)");
+  assert.ok(res.wallMs >= 1400, `Wall time ${res.wallMs}ms is shorter than the limit`);
+  assert.strictEqual(res.elapsedMs, res.wallMs, "Elapsed should be the wall time");
+  assert.ok(res.cpuMs > res.wallMs, `CPU ${res.cpuMs}ms should exceed wall ${res.wallMs}ms`);
+  assert.ok(res.threadCount >= 4, `Peak thread count ${res.threadCount} should be at least 4`);
+  assert.strictEqual(res.threadCpuMs.length, res.threadCount);
+});
+
 test("Thread Pool Concurrency (libuv)", { timeout: 15000 }, async () => {
   // Default UV_THREADPOOL_SIZE is 4.
   // We spawn 6 processes that sleep for 2000ms.
@@ -470,6 +510,37 @@ test("External Stop: Sets stopped flag", { timeout: 10000 }, async () => {
   assert.strictEqual(res.memoryLimitExceeded, false, "Should not be memory limited");
 });
 
+test(
+  "Cancel Group: Stops every member at once",
+  { timeout: 15000, skip: process.platform !== "linux" },
+  async () => {
+    // More members than threadpool threads, so most workers haven't started
+    // polling when the group is cancelled
+    const count = 12;
+    const group = monitor.createCancelGroup();
+    const runs = [];
+    for (let i = 0; i < count; i++) {
+      runs.push(
+        spawnPromise(["-e", "setTimeout(() => {}, 10000)"], {
+          spawnOptions: { cancelGroup: group },
+        })
+      );
+    }
+    await new Promise((r) => setTimeout(r, 1000));
+
+    const start = Date.now();
+    assert.strictEqual(group.cancel(), count, "Every member should still be running");
+    const results = await Promise.all(runs);
+    const stopMs = Date.now() - start;
+
+    for (const res of results) {
+      assert.strictEqual(res.stopped, true, "Should have stopped=true");
+    }
+    assert.ok(stopMs < 1000, `Stopping ${count} runs took ${stopMs}ms`);
+    assert.strictEqual(group.cancel(), 0, "Finished runs should leave the group");
+  }
+);
+
 test(
   "Execution: Crashes do not set stopped flag",
   { timeout: 10000, skip: process.platform === "win32" },
@@ -506,6 +577,92 @@ test("Execution: Non-zero exit code", { timeout: 10000 }, async () => {
   assert.strictEqual(res.memoryLimitExceeded, false, "Should not be memory limited");
 });
 
+test(
+  "Spawn Options: CPU affinity",
+  { timeout: 10000, skip: process.platform !== "linux" },
+  async () => {
+    // The last CPU this process may run on, since a cpuset can exclude some of them
+    const allowed = fs
+      .readFileSync("/proc/self/status", "utf8")
+      .match(/Cpus_allowed_list:\s+(\S+)/)[1];
+    const cpu = Math.max(...allowed.split(",").map((range) => Number(range.split("-").at(-1))));
+    const res = await spawnPromise(
+      ["-e", 'process.stdout.write(require("fs").readFileSync("/proc/self/status", "utf8"))'],
+      { spawnOptions: { cpuAffinity: cpu } }
+    );
+
+    assert.strictEqual(res.exitCode, 0);
+    assert.match(res.output, new RegExp(`Cpus_allowed_list:\\s+${cpu}\\n`));
+  }
+);
+
+test(
+  "Spawn Options: Disable transparent huge pages",
+  { timeout: 10000, skip: process.platform !== "linux" },
+  async () => {
+    const readThpEnabled = (status) => status.match(/THP_enabled:\s+(\d)/)?.[1];
+    const before = readThpEnabled(fs.readFileSync("/proc/self/status", "utf8"));
+    const res = await spawnPromise(
+      ["-e", 'process.stdout.write(require("fs").readFileSync("/proc/self/status", "utf8"))'],
+      { spawnOptions: { transparentHugePages: "never" } }
+    );
+
+    assert.strictEqual(res.exitCode, 0);
+    assert.strictEqual(readThpEnabled(res.output), "0", "The child should have THP disabled");
+    assert.strictEqual(typeof res.hugePageBytes, "number");
+    assert.strictEqual(
+      readThpEnabled(fs.readFileSync("/proc/self/status", "utf8")),
+      before,
+      "The flag must not leak into this process through vfork"
+    );
+  }
+);
+
+test("Spawn Options: Custom environment", { timeout: 10000 }, async () => {
+  const res = await spawnPromise(
+    ["-e", "process.stdout.write(`${process.env.FOC_TEST_VALUE}:${process.env.HOME ?? ''}`)"],
+    { spawnOptions: { env: ["FOC_TEST_VALUE=42"] } }
+  );
+
+  assert.strictEqual(res.exitCode, 0);
+  assert.strictEqual(res.output, "42:", "Only the given environment should be visible");
+});
+
+const forkServerShimPath = path.join(
+  __dirname,
+  "..",
+  "build",
+  "Release",
+  "lib.target",
+  "linux-forkserver-shim.so"
+);
+
+test(
+  "Fork Server: Each spawn runs main with its own stdio and limits",
+  { timeout: 15000, skip: process.platform !== "linux" },
+  async () => {
+    const server = await monitor.startForkServer(
+      "/bin/sh",
+      ["-c", 'read x; [ "$x" = spin ] && while :; do :; done; echo $((x * 2)); exit 3'],
+      process.cwd(),
+      forkServerShimPath
+    );
+    try {
+      for (const x of [1, 2, 3]) {
+        const res = await spawnPromise([], { forkServer: server, input: `${x}\n` });
+        assert.strictEqual(res.exitCode, 3);
+        assert.strictEqual(res.output, `${x * 2}\n`);
+      }
+
+      const res = await spawnPromise([], { forkServer: server, input: "spin\n", timeoutMs: 300 });
+      assert.strictEqual(res.timedOut, true, "Fork server children should be time limited");
+      assert.ok(res.cpuMs >= 300, `Expected the server to report the child's CPU time, got ${res.cpuMs}ms`);
+    } finally {
+      server.close();
+    }
+  }
+);
+
 test("Execution: Invalid Command", { timeout: 10000 }, async () => {
   try {
     // Attempt to run a non-existent command
@@ -0,0 +1,397 @@
+// Soak harness for the process monitor addon, for leaks that the unit tests are too short to
+// show: fds (eventfds, pidfds, sockets), zombies, held threadpool threads, and RSS growth.
+//
+//   npm run test:soak -- [--spawns 200000] [--concurrency 64] [--round 2000]
+//
+// Spawns run in rounds. Every round mixes normal exits, time limits, memory limits, cancels
+// racing with exit, and exec failures, then waits for all of them, so the checkpoint after
+// it sees the process at rest. Exits with 1 when a resource grew or throughput degraded.
+// Linux and macOS only, since the workloads are POSIX shell commands.
+
+const { parseArgs } = require("node:util");
+const { execFileSync } = require("node:child_process");
+const path = require("node:path");
+const fs = require("node:fs");
+const net = require("node:net");
+const os = require("node:os");
+const crypto = require("node:crypto");
+
+const { values: args } = parseArgs({
+  options: {
+    spawns: { type: "string", default: "200000" },
+    concurrency: { type: "string", default: "64" },
+    round: { type: "string", default: "2000" },
+    warmup: { type: "string", default: "2" }, // rounds before the baseline checkpoint
+  },
+});
+const totalSpawns = Number(args.spawns);
+const concurrency = Number(args.concurrency);
+const roundSize = Number(args.round);
+const warmupRounds = Number(args.warmup);
+
+if (process.platform !== "linux" && process.platform !== "darwin") {
+  console.error(`The soak harness runs on Linux and macOS only, not ${process.platform}`);
+  process.exit(2);
+}
+
+const addonPath = path.join(__dirname, "..", "build", "Release", `${process.platform}-process-monitor.node`);
+if (!fs.existsSync(addonPath)) {
+  console.error(`Addon not found at ${addonPath}. Run 'npm run build:addon' first.`);
+  process.exit(2);
+}
+const monitor = require(addonPath);
+
+// --- Workloads ---
+
+// Weights add up to 100. Each check returns whether the result is what the kind expects.
+const KINDS = [
+  {
+    name: "exit",
+    weight: 50,
+    command: "/bin/cat",
+    args: [],
+    input: "soak\n",
+    check: (res) => res.exitCode === 0 && res.output === "soak\n",
+  },
+  {
+    name: "timeout",
+    weight: 12,
+    command: "/bin/sh",
+    args: ["-c", "while :; do :; done"],
+    timeoutMs: 50,
+    check: (res) => res.timedOut,
+  },
+  {
+    name: "memory",
+    weight: 8,
+    command: "/bin/sh",
+    args: ["-c", 'x=$(head -c 67108864 /dev/zero | tr "\\0" a); echo ${#x}'],
+    memoryLimitMB: 8,
+    timeoutMs: 5000,
+    check: (res) => res.memoryLimitExceeded,
+  },
+  {
+    name: "cancel",
+    weight: 15,
+    command: "/bin/sleep",
+    args: ["5"],
+    cancelAfterMs: () => Math.random() * 5,
+    check: (res) => res.stopped,
+  },
+  {
+    // Cancel right as a trivial process exits, either outcome is fine but nothing may leak
+    name: "cancel-race",
+    weight: 10,
+    command: "/bin/true",
+    args: [],
+    cancelAfterMs: () => 0,
+    check: (res) => res.stopped || res.exitCode === 0,
+  },
+  {
+    name: "exec-failure",
+    weight: 5,
+    command: "/nonexistent/foc-soak",
+    args: [],
+    expectThrow: true,
+    check: () => false,
+  },
+];
+
+function pickKind() {
+  let roll = Math.random() * 100;
+  for (const kind of KINDS) {
+    roll -= kind.weight;
+    if (roll < 0) {
+      return kind;
+    }
+  }
+  return KINDS[0];
+}
+
+function listen(pipeName) {
+  return new Promise((resolve, reject) => {
+    const server = net.createServer();
+    server.once("error", reject);
+    server.listen(pipeName, () => resolve(server));
+  });
+}
+
+// Spawns one process like Runnable does and resolves with the addon result and its stdout
+async function runOnce(kind) {
+  const id = crypto.randomBytes(8).toString("hex");
+  const pipeNames = ["in", "out", "err"].map((name) =>
+    path.join(os.tmpdir(), `foc-soak-${id}-${name}.sock`)
+  );
+  const servers = await Promise.all(pipeNames.map(listen));
+  const connections = servers.map(
+    (server) => new Promise((resolve) => server.once("connection", resolve))
+  );
+
+  let spawned;
+  try {
+    spawned = monitor.spawn(
+      kind.command,
+      kind.args,
+      process.cwd(),
+      kind.timeoutMs ?? 0,
+      kind.memoryLimitMB ?? 0,
+      ...pipeNames,
+      () => {}
+    );
+  } catch (err) {
+    // The child may have connected before exec failed
+    connections.forEach((connection) => connection.then((socket) => socket.destroy()));
+    servers.forEach((server) => server.close());
+    if (kind.expectThrow) {
+      return { ok: true };
+    }
+    throw err;
+  }
+
+  if (kind.cancelAfterMs) {
+    setTimeout(spawned.cancel, kind.cancelAfterMs());
+  }
+
+  const [stdin, stdout, stderr] = await Promise.all(connections);
+  servers.forEach((server) => server.close());
+  stdin.end(kind.input ?? "");
+  let output = "";
+  stdout.setEncoding("utf8");
+  stdout.on("data", (chunk) => (output += chunk));
+  stderr.resume();
+  const closed = [stdout, stderr].map((socket) => new Promise((resolve) => socket.on("close", resolve)));
+  const [result] = await Promise.all([spawned.result, ...closed]);
+  stdin.destroy();
+  return { ok: kind.check({ ...result, output }) };
+}
+
+// --- Resource sampling ---
+
+// Open fds of this process by kind, so a leak points at what leaked
+function countFds() {
+  const counts = { total: 0, eventfd: 0, pidfd: 0, socket: 0, pipe: 0, other: 0 };
+  const dir = process.platform === "linux" ? "/proc/self/fd" : "/dev/fd";
+  for (const fd of fs.readdirSync(dir)) {
+    counts.total++;
+    if (process.platform !== "linux") {
+      continue;
+    }
+    let target = "";
+    try {
+      target = fs.readlinkSync(path.join(dir, fd));
+    } catch {
+      continue; // the fd readdir itself used
+    }
+    if (target.includes("[eventfd]")) counts.eventfd++;
+    else if (target.includes("[pidfd]")) counts.pidfd++;
+    else if (target.startsWith("socket:")) counts.socket++;
+    else if (target.startsWith("pipe:")) counts.pipe++;
+    else counts.other++;
+  }
+  return counts;
+}
+
+function countZombies() {
+  const output = execFileSync("ps", ["-A", "-o", "ppid=,stat="], { encoding: "utf8" });
+  return output
+    .split("\n")
+    .map((line) => line.trim().split(/\s+/))
+    .filter(([ppid, stat]) => Number(ppid) === process.pid && stat?.startsWith("Z")).length;
+}
+
+// Includes libuv threadpool threads, which a worker stuck in Execute() would hold
+function countThreads() {
+  if (process.platform !== "linux") {
+    return null;
+  }
+  const status = fs.readFileSync("/proc/self/status", "utf8");
+  return Number(status.match(/^Threads:\s+(\d+)/m)?.[1] ?? 0);
+}
+
+function percentile(values, p) {
+  if (values.length === 0) {
+    return 0;
+  }
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.min(sorted.length - 1, Math.floor((sorted.length * p) / 100))];
+}
+
+function mean(values) {
+  return values.reduce((sum, value) => sum + value, 0) / Math.max(values.length, 1);
+}
+
+// Least squares slope of y over x
+function slope(xs, ys) {
+  const mx = mean(xs);
+  const my = mean(ys);
+  const num = xs.reduce((sum, x, i) => sum + (x - mx) * (ys[i] - my), 0);
+  const den = xs.reduce((sum, x) => sum + (x - mx) ** 2, 0);
+  return den === 0 ? 0 : num / den;
+}
+
+// --- Rounds ---
+
+const poolSize = Number(process.env.UV_THREADPOOL_SIZE ?? 4);
+
+async function runRound(size) {
+  const latencies = []; // spawn to result of trivial exits, grows when pool threads are held
+  const occupancy = [];
+  let unexpected = 0;
+  let inFlight = 0;
+  let started = 0;
+
+  const sampler = setInterval(() => occupancy.push(Math.min(inFlight / poolSize, 1)), 100);
+  const start = performance.now();
+  const worker = async () => {
+    while (started < size) {
+      started++;
+      const kind = pickKind();
+      const spawnStart = performance.now();
+      inFlight++;
+      try {
+        const { ok } = await runOnce(kind);
+        if (!ok) {
+          unexpected++;
+        }
+      } catch (err) {
+        unexpected++;
+        console.error(`${kind.name} failed: ${err instanceof Error ? err.message : err}`);
+      } finally {
+        inFlight--;
+      }
+      if (kind.name === "exit") {
+        latencies.push(performance.now() - spawnStart);
+      }
+    }
+  };
+  await Promise.all(Array.from({ length: Math.min(concurrency, size) }, worker));
+  const seconds = (performance.now() - start) / 1000;
+  clearInterval(sampler);
+
+  return {
+    throughput: size / seconds,
+    p50: percentile(latencies, 50),
+    p99: percentile(latencies, 99),
+    occupancy: mean(occupancy),
+    unexpected,
+  };
+}
+
+function checkpoint(spawns, round) {
+  global.gc?.();
+  return {
+    spawns,
+    ...round,
+    fds: countFds(),
+    zombies: countZombies(),
+    threads: countThreads(),
+    rss: process.memoryUsage().rss,
+  };
+}
+
+function formatCheckpoint(c) {
+  const mb = (bytes) => (bytes / (1024 * 1024)).toFixed(1);
+  return [
+    `${String(c.spawns).padStart(8)} spawns`,
+    `${c.throughput.toFixed(0).padStart(5)}/s`,
+    `p50 ${c.p50.toFixed(1)}ms p99 ${c.p99.toFixed(1)}ms`,
+    `pool ${(c.occupancy * 100).toFixed(0)}%`,
+    `fds ${c.fds.total} (eventfd ${c.fds.eventfd}, pidfd ${c.fds.pidfd}, socket ${c.fds.socket})`,
+    `zombies ${c.zombies}`,
+    `threads ${c.threads ?? "-"}`,
+    `rss ${mb(c.rss)}MB`,
+    c.unexpected > 0 ? `unexpected ${c.unexpected}` : "",
+  ]
+    .filter(Boolean)
+    .join("  ");
+}
+
+// Compares the end of the run against the checkpoint after warm-up
+function analyze(checkpoints) {
+  const problems = [];
+  const baseline = checkpoints[Math.min(warmupRounds, checkpoints.length) - 1];
+  const final = checkpoints[checkpoints.length - 1];
+  const steady = checkpoints.slice(Math.min(warmupRounds, checkpoints.length) - 1);
+
+  for (const key of Object.keys(final.fds)) {
+    if (final.fds[key] > baseline.fds[key]) {
+      problems.push(`${key} fds grew from ${baseline.fds[key]} to ${final.fds[key]}`);
+    }
+  }
+  if (final.zombies > 0) {
+    problems.push(`${final.zombies} zombie children at rest`);
+  }
+  if (final.threads !== null && final.threads > baseline.threads) {
+    problems.push(`threads grew from ${baseline.threads} to ${final.threads}`);
+  }
+
+  // A little RSS drift is the heap settling, a steady slope is a leak
+  const rssSlope = slope(
+    steady.map((c) => c.spawns),
+    steady.map((c) => c.rss)
+  );
+  const rssPer10k = (rssSlope * 10000) / (1024 * 1024);
+  if (final.rss > baseline.rss * 1.2 && rssPer10k > 1) {
+    problems.push(`RSS grows ${rssPer10k.toFixed(2)}MB per 10k spawns`);
+  }
+
+  const quarter = Math.max(Math.floor(steady.length / 4), 1);
+  const first = steady.slice(0, quarter);
+  const last = steady.slice(-quarter);
+  const throughputRatio = mean(last.map((c) => c.throughput)) / mean(first.map((c) => c.throughput));
+  const throughputs = steady.map((c) => c.throughput);
+  const throughputCv =
+    Math.sqrt(mean(throughputs.map((t) => (t - mean(throughputs)) ** 2))) / mean(throughputs);
+  if (throughputRatio < 0.8) {
+    problems.push(`throughput fell to ${(throughputRatio * 100).toFixed(0)}% of the start`);
+  }
+  const latencyRatio = mean(last.map((c) => c.p99)) / mean(first.map((c) => c.p99));
+  if (latencyRatio > 1.5) {
+    problems.push(`p99 latency of trivial runs rose ${latencyRatio.toFixed(2)}x`);
+  }
+
+  const unexpected = checkpoints.reduce((sum, c) => sum + c.unexpected, 0);
+  if (unexpected > 0) {
+    problems.push(`${unexpected} runs ended unlike their kind expects`);
+  }
+
+  console.log("");
+  console.log(`RSS slope: ${rssPer10k.toFixed(2)}MB per 10k spawns`);
+  console.log(
+    `Throughput: ${mean(throughputs).toFixed(0)}/s, CV ${(throughputCv * 100).toFixed(1)}%, last/first quarter ${throughputRatio.toFixed(2)}`
+  );
+  console.log(`p99 latency last/first quarter: ${latencyRatio.toFixed(2)}`);
+  return problems;
+}
+
+async function main() {
+  console.log(
+    `Soaking ${totalSpawns} spawns, ${concurrency} at a time, checkpoint every ${roundSize} (pool size ${poolSize})`
+  );
+  console.log(KINDS.map((kind) => `${kind.name} ${kind.weight}%`).join(", "));
+  console.log("");
+
+  const checkpoints = [];
+  let spawns = 0;
+  while (spawns < totalSpawns) {
+    const size = Math.min(roundSize, totalSpawns - spawns);
+    const round = await runRound(size);
+    spawns += size;
+    const c = checkpoint(spawns, round);
+    checkpoints.push(c);
+    console.log(formatCheckpoint(c));
+  }
+
+  const problems = analyze(checkpoints);
+  if (problems.length > 0) {
+    console.log("");
+    problems.forEach((problem) => console.log(`LEAK: ${problem}`));
+    process.exit(1);
+  }
+  console.log("No growth detected");
+}
+
+main().catch((err) => {
+  console.error(err);
+  process.exit(2);
+});